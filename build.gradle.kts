@@ -4,6 +4,8 @@ plugins {
     id("com.android.library") version "8.9.2" apply false
     id("com.android.application") version "8.9.2" apply false
     id("org.jetbrains.kotlin.plugin.compose") version "2.0.20" apply false
+    kotlin("plugin.allopen") version "2.0.20" apply false
+    id("org.jetbrains.kotlinx.benchmark") version "0.4.11" apply false
 }
 
 group = "com.dayushman.pathsense"
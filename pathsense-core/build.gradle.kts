@@ -3,6 +3,13 @@ plugins {
     id("com.android.library")
     id("maven-publish")
     id("signing")
+    kotlin("plugin.allopen")
+    id("org.jetbrains.kotlinx.benchmark")
+}
+
+// JMH requires @State classes to be open.
+allOpen {
+    annotation("org.openjdk.jmh.annotations.State")
 }
 
 kotlin {
@@ -16,6 +23,12 @@ kotlin {
             }
         }
     }
+    // Plain JVM target: hosts the benchmark suite and runs on any Linux box.
+    jvm {
+        compilations.create("benchmark") {
+            associateWith(this@jvm.compilations.getByName("main"))
+        }
+    }
     val xcf = org.jetbrains.kotlin.gradle.plugin.mpp.apple.XCFrameworkConfig(project, "PathSenseCore")
     listOf(iosX64(), iosArm64(), iosSimulatorArm64()).forEach {
         it.binaries.framework {
@@ -28,11 +41,13 @@ kotlin {
         val commonMain by getting {
             dependencies {
                 implementation("org.jetbrains.kotlinx:kotlinx-coroutines-core:1.8.1")
+                implementation("org.jetbrains.kotlinx:atomicfu:0.25.0")
             }
         }
         val commonTest by getting {
             dependencies {
                 implementation(kotlin("test"))
+                implementation("org.jetbrains.kotlinx:kotlinx-coroutines-test:1.8.1")
             }
         }
         val androidMain by getting {
@@ -40,6 +55,11 @@ kotlin {
                 implementation("org.jetbrains.kotlinx:kotlinx-coroutines-android:1.8.1")
             }
         }
+        val jvmBenchmark by getting {
+            dependencies {
+                implementation("org.jetbrains.kotlinx:kotlinx-benchmark-runtime:0.4.11")
+            }
+        }
         val iosMain by creating {
             dependsOn(commonMain)
         }
@@ -49,6 +69,29 @@ kotlin {
     }
 }
 
+benchmark {
+    targets {
+        register("jvmBenchmark")
+    }
+    configurations {
+        named("main") {
+            warmups = 3
+            iterations = 5
+            iterationTime = 1
+            iterationTimeUnit = "s"
+            // Report allocation rate (bytes/op) next to each score.
+            advanced("jvmProfiler", "gc")
+        }
+        register("smoke") {
+            warmups = 1
+            iterations = 1
+            iterationTime = 200
+            iterationTimeUnit = "ms"
+            advanced("jvmProfiler", "gc")
+        }
+    }
+}
+
 android {
     namespace = "com.dayushmand.pathsense.core"
     compileSdk = 34
@@ -0,0 +1,143 @@
+package com.dayushmand.pathsense.core
+
+import kotlinx.atomicfu.locks.SynchronizedObject
+import kotlinx.atomicfu.locks.synchronized
+import kotlinx.coroutines.CancellationException
+import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.SupervisorJob
+import kotlinx.coroutines.channels.Channel
+import kotlinx.coroutines.isActive
+import kotlinx.coroutines.launch
+
+/**
+ * Process-wide analysis worker shared by every tracker.
+ *
+ * Trackers post snapshots to their own [AnalysisMailbox]; the engine keeps a
+ * queue of mailboxes with pending work, each listed at most once, so the queue
+ * is bounded by the number of open trackers no matter how fast points arrive.
+ * One coroutine drains it, so a tracker costs no scope, channel or worker.
+ * A mailbox whose handler throws (a listener or recognizer failing) is
+ * closed, so the failure stops only that tracker's analysis.
+ */
+internal object AnalysisEngine {
+    private val scope = CoroutineScope(SupervisorJob() + Dispatchers.Default)
+    private val lock = SynchronizedObject()
+    private val ready = LinkedHashSet<AnalysisMailbox>()
+    private val wakeups = Channel<Unit>(Channel.CONFLATED)
+
+    init {
+        scope.launch {
+            for (wakeup in wakeups) {
+                while (true) {
+                    val mailbox = poll() ?: break
+                    try {
+                        mailbox.drain()
+                    } catch (e: Throwable) {
+                        if (e is CancellationException && !isActive) throw e
+                        mailbox.close()
+                    }
+                }
+            }
+        }
+    }
+
+    fun submit(mailbox: AnalysisMailbox) {
+        val added = synchronized(lock) { ready.add(mailbox) }
+        if (added) wakeups.trySend(Unit)
+    }
+
+    fun withdraw(mailbox: AnalysisMailbox) {
+        synchronized(lock) { ready.remove(mailbox) }
+    }
+
+    private fun poll(): AnalysisMailbox? {
+        synchronized(lock) {
+            val it = ready.iterator()
+            if (!it.hasNext()) return null
+            val next = it.next()
+            it.remove()
+            return next
+        }
+    }
+}
+
+/**
+ * A tracker's inbox on the [AnalysisEngine]: the latest live snapshot per
+ * session slot (older ones are conflated away) plus every final snapshot in
+ * order, so no stroke misses its recognition. A conflated snapshot's
+ * early-recognition candidate is carried into its replacement when that has
+ * none, since the session only attaches one every few samples.
+ *
+ * [handler] runs on the analysis worker with the slot, the tag it was posted
+ * with (the pointer id for multi-pointer trackers) and the snapshot; it hops
+ * to the main thread itself to deliver events.
+ */
+internal class AnalysisMailbox(
+    slots: Int,
+    private val stats: StatsRecorder? = null,
+    private val handler: suspend (slot: Int, tag: Int, snapshot: PathSnapshot) -> Unit,
+) {
+    private val lock = SynchronizedObject()
+    private val live = arrayOfNulls<PathSnapshot>(slots)
+    private val liveTags = IntArray(slots)
+    private val finals = ArrayDeque<PendingFinal>()
+    private var closed = false
+
+    fun postLive(slot: Int, tag: Int, snapshot: PathSnapshot) {
+        synchronized(lock) {
+            if (closed) return
+            val replaced = live[slot]
+            if (replaced != null) stats?.onConflated()
+            live[slot] = if (replaced != null && snapshot.points.isEmpty() && replaced.points.isNotEmpty() &&
+                replaced.sessionId == snapshot.sessionId
+            ) {
+                snapshot.copy(points = replaced.points)
+            } else {
+                snapshot
+            }
+            liveTags[slot] = tag
+        }
+        AnalysisEngine.submit(this)
+    }
+
+    fun postFinal(slot: Int, tag: Int, snapshot: PathSnapshot) {
+        synchronized(lock) {
+            if (closed) return
+            finals.addLast(PendingFinal(slot, tag, snapshot))
+        }
+        AnalysisEngine.submit(this)
+    }
+
+    /** Drops pending work and stops delivery; the engine forgets this mailbox. */
+    fun close() {
+        synchronized(lock) {
+            closed = true
+            live.fill(null)
+            finals.clear()
+        }
+        AnalysisEngine.withdraw(this)
+    }
+
+    internal suspend fun drain() {
+        // Live first, so a path's MetricsUpdated never trails its MetricsEnded.
+        for (slot in live.indices) {
+            var tag = 0
+            val snapshot = synchronized(lock) {
+                val s = live[slot]
+                live[slot] = null
+                tag = liveTags[slot]
+                if (closed) null else s
+            } ?: continue
+            handler(slot, tag, snapshot)
+        }
+        while (true) {
+            val pending = synchronized(lock) {
+                if (closed) null else finals.removeFirstOrNull()
+            } ?: break
+            handler(pending.slot, pending.tag, pending.snapshot)
+        }
+    }
+
+    private class PendingFinal(val slot: Int, val tag: Int, val snapshot: PathSnapshot)
+}
@@ -0,0 +1,97 @@
+package com.dayushmand.pathsense.core
+
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.channels.Channel
+import kotlinx.coroutines.flow.Flow
+import kotlinx.coroutines.flow.buffer
+import kotlinx.coroutines.flow.channelFlow
+import kotlinx.coroutines.launch
+
+/** One recorded stroke for [BatchAnalyzer], as parallel primitive columns. */
+class BatchStroke(
+    val id: Long,
+    val xs: FloatArray,
+    val ys: FloatArray,
+    val ts: LongArray,
+    override val size: Int = xs.size,
+) : PointView {
+    override fun x(index: Int): Float = xs[index]
+
+    override fun y(index: Int): Float = ys[index]
+
+    override fun tMillis(index: Int): Long = ts[index]
+}
+
+/** Metrics and best match for the [BatchStroke] with the same [id]. */
+data class BatchResult(
+    val id: Long,
+    val metrics: PathMetrics,
+    val match: GestureMatch?,
+)
+
+/**
+ * Headless, parallel re-scoring of large gesture corpora, e.g. recorded
+ * strokes re-run server-side whenever templates change.
+ *
+ * [analyze] fans strokes out to [workers] coroutines on [Dispatchers.Default]
+ * (a work-stealing pool on the JVM); each pulls the next stroke as soon as it
+ * is free, so uneven strokes balance themselves. Every worker owns its own
+ * copy of [templates], normalizer scratch and [recognizers] instances, so
+ * workers never contend and steady-state scoring allocates only the results.
+ * Input and output are bounded channels, so memory stays flat however large
+ * the corpus.
+ */
+class BatchAnalyzer(
+    private val templates: TemplateLibrary = TemplateLibrary.withDefaults(),
+    private val recognizers: () -> List<GestureRecognizer> = { emptyList() },
+    private val threshold: Float = 0.75f,
+    val workers: Int = availableProcessors(),
+) {
+    // Needed for Swift interop — KMM doesn't export default param values to ObjC/Swift
+    constructor() : this(TemplateLibrary.withDefaults())
+
+    /**
+     * Scores every stroke of [strokes] and emits one [BatchResult] each as
+     * soon as it is ready. Results arrive in completion order; match them up
+     * by [BatchResult.id].
+     */
+    fun analyze(strokes: Flow<BatchStroke>): Flow<BatchResult> = channelFlow {
+        val queue = Channel<BatchStroke>(workers * QUEUE_PER_WORKER)
+        launch {
+            try {
+                strokes.collect { queue.send(it) }
+            } finally {
+                queue.close()
+            }
+        }
+        repeat(workers.coerceAtLeast(1)) {
+            launch(Dispatchers.Default) {
+                val worker = Worker()
+                for (stroke in queue) send(worker.analyze(stroke))
+            }
+        }
+    }.buffer(workers * QUEUE_PER_WORKER)
+
+    /** Per-worker state; confined to one coroutine. */
+    private inner class Worker {
+        private val dollarOne = DollarOneRecognizer(templates.copy(), threshold)
+        private val extra = recognizers()
+
+        fun analyze(stroke: BatchStroke): BatchResult {
+            val metrics = computeMetrics(stroke)
+            var best = dollarOne.recognize(stroke)
+            if (extra.isNotEmpty()) {
+                val points = stroke.toList()
+                for (r in extra) {
+                    val match = r.recognize(points) ?: continue
+                    if (best == null || match.score > best.score) best = match
+                }
+            }
+            return BatchResult(stroke.id, metrics, best)
+        }
+    }
+
+    private companion object {
+        const val QUEUE_PER_WORKER = 4
+    }
+}
@@ -0,0 +1,191 @@
+package com.dayushmand.pathsense.core
+
+import kotlinx.atomicfu.atomic
+import kotlinx.atomicfu.locks.SynchronizedObject
+import kotlinx.atomicfu.locks.synchronized
+import kotlinx.atomicfu.update
+import kotlinx.coroutines.CancellationException
+import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.SupervisorJob
+import kotlinx.coroutines.channels.Channel
+import kotlinx.coroutines.currentCoroutineContext
+import kotlinx.coroutines.launch
+import kotlinx.coroutines.sync.Mutex
+import kotlinx.coroutines.withContext
+
+/**
+ * Turns [PathSnapshot]s into metrics and recognition events; shared by every
+ * session of a tracker.
+ *
+ * [analyze] runs on the analysis worker: recognizers are evaluated there, in
+ * parallel when there are several, and only finished events hop to the main
+ * thread. The recognizer set is copy-on-write, so [add] and [remove] are safe
+ * from any thread while a fan-out is reading it.
+ *
+ * A recognizer is never entered twice at once, even though a cancelled
+ * straggler keeps running until its call returns: live predictions skip a
+ * recognizer that is still busy, final recognition waits for it. A recognizer
+ * that throws counts as no match and is recorded in [PathStats].
+ */
+internal class GestureAnalyzer(
+    private val config: PathConfig,
+    private val stats: StatsRecorder? = null,
+) {
+    private val recognizers = atomic(emptyList<GestureRecognizer>())
+
+    // One gate per recognizer with a call running or waiting; dropped when idle.
+    private val gateLock = SynchronizedObject()
+    private val gates = HashMap<GestureRecognizer, Gate>()
+
+    // Analysis worker only, like everything else that runs in analyze().
+    private val kinematics = KinematicsKernel()
+
+    fun add(r: GestureRecognizer) {
+        recognizers.update { if (r in it) it else it + r }
+    }
+
+    fun remove(r: GestureRecognizer) {
+        recognizers.update { it - r }
+    }
+
+    /** Analyzes one snapshot; [deliver] is invoked on the main thread. */
+    suspend fun analyze(snapshot: PathSnapshot, session: PathSession, deliver: (PathEvent) -> Unit) {
+        val id = snapshot.sessionId
+        val columns = snapshot.columns ?: snapshot.liveColumns?.copyFor(id)
+        val metrics = if (columns == null) {
+            snapshot.metrics
+        } else {
+            snapshot.metrics.copy(kinematics = kinematics.compute(columns))
+        }
+        if (snapshot.isFinal) {
+            withContext(MainDispatcher) { deliver(PathEvent.MetricsEnded(id, metrics)) }
+            val match = fanOut(snapshot.points, partial = false) ?: return
+            withContext(MainDispatcher) { deliver(PathEvent.GestureRecognized(id, match)) }
+            return
+        }
+        val predicted = if (snapshot.points.isEmpty()) null else newPrediction(snapshot, session)
+        withContext(MainDispatcher) {
+            if (stats != null) stats.metricsDelay.record(stats.nanosNow() - snapshot.postedNanos)
+            deliver(PathEvent.MetricsUpdated(id, metrics))
+            if (predicted != null) deliver(PathEvent.GesturePredicted(id, predicted))
+        }
+    }
+
+    // Session prediction state is only touched here, one snapshot at a time.
+    private suspend fun newPrediction(snapshot: PathSnapshot, session: PathSession): GestureMatch? {
+        val match = fanOut(snapshot.points, partial = true) ?: return null
+        val last = session.predicted
+        if (session.predictedFor == snapshot.sessionId && last != null &&
+            last.type == match.type && last.templateName == match.templateName
+        ) {
+            return null
+        }
+        session.predictedFor = snapshot.sessionId
+        session.predicted = match
+        return match
+    }
+
+    /**
+     * Best match across all recognizers, run in parallel. Once one reaches
+     * [PathConfig.recognitionGoodEnoughScore] nothing waits for the
+     * stragglers and any result they still produce is dropped. Partial passes
+     * cancel them; final ones let them finish, so stateful recognizers (e.g.
+     * $Q merging strokes) still see every completed stroke.
+     */
+    internal suspend fun fanOut(points: List<PathPoint>, partial: Boolean): GestureMatch? {
+        val all = recognizers.value
+        if (all.size == 1) return evaluateExclusive(all[0], points, partial)
+        // Not children of this coroutine: a blocking straggler must not hold up the result.
+        val stragglers = SupervisorJob()
+        val results = Channel<GestureMatch?>(all.size)
+        val scope = CoroutineScope(currentCoroutineContext() + stragglers)
+        try {
+            for (r in all) {
+                scope.launch {
+                    var match: GestureMatch? = null
+                    try {
+                        match = evaluateExclusive(r, points, partial)
+                    } finally {
+                        results.trySend(match)
+                    }
+                }
+            }
+            var best: GestureMatch? = null
+            repeat(all.size) {
+                val match = results.receive()
+                if (match != null && (best == null || match.score > best!!.score)) {
+                    best = match
+                }
+                if (best != null && best!!.score >= config.recognitionGoodEnoughScore) return best
+            }
+            return best
+        } finally {
+            if (partial) stragglers.cancel() else stragglers.complete()
+        }
+    }
+
+    private suspend fun evaluateExclusive(r: GestureRecognizer, points: List<PathPoint>, partial: Boolean): GestureMatch? {
+        val gate = (if (partial) tryEnter(r) else enter(r)) ?: return null
+        try {
+            return evaluate(r, points, partial)
+        } catch (e: CancellationException) {
+            throw e
+        } catch (e: Throwable) {
+            // A broken recognizer must not take down the shared analysis worker.
+            stats?.onRecognizerFailed()
+            return null
+        } finally {
+            exit(r, gate)
+        }
+    }
+
+    // Predictions are superseded by the next snapshot, so a busy recognizer just sits one out.
+    private fun tryEnter(r: GestureRecognizer): Gate? = synchronized(gateLock) {
+        val gate = gates.getOrPut(r) { Gate() }
+        if (!gate.mutex.tryLock()) return null
+        gate.users++
+        gate
+    }
+
+    private suspend fun enter(r: GestureRecognizer): Gate {
+        val gate = synchronized(gateLock) { gates.getOrPut(r) { Gate() }.also { it.users++ } }
+        try {
+            gate.mutex.lock()
+        } catch (e: Throwable) {
+            release(r, gate)
+            throw e
+        }
+        return gate
+    }
+
+    private fun exit(r: GestureRecognizer, gate: Gate) {
+        gate.mutex.unlock()
+        release(r, gate)
+    }
+
+    private fun release(r: GestureRecognizer, gate: Gate) {
+        synchronized(gateLock) {
+            if (--gate.users == 0) gates.remove(r)
+        }
+    }
+
+    private class Gate {
+        val mutex = Mutex()
+
+        // Calls holding or waiting for the mutex; guarded by gateLock.
+        var users = 0
+    }
+
+    private fun evaluate(r: GestureRecognizer, points: List<PathPoint>, partial: Boolean): GestureMatch? {
+        if (!partial) {
+            if (stats == null) return r.recognize(points)
+            val start = stats.nanosNow()
+            val match = r.recognize(points)
+            stats.recordRecognition(r, stats.nanosNow() - start)
+            return match
+        }
+        val match = r.recognizePartial(points) ?: return null
+        if (match.type == GestureType.UNKNOWN || match.score < config.earlyRecognitionThreshold) return null
+        return match
+    }
+}
@@ -0,0 +1,244 @@
+package com.dayushmand.pathsense.core
+
+import kotlin.math.max
+import kotlin.math.roundToInt
+
+/**
+ * The last finished strokes of a tracker, compressed into one fixed-size
+ * byte arena for undo, replay and analytics.
+ *
+ * Each stroke is stored as its first point followed by quantized int16
+ * coordinate deltas (1/[unitsPerPx] px) and varint time deltas, about 5 bytes
+ * per point. Once the arena or the [maxStrokes] table is full, the least
+ * recently recorded or read strokes are evicted and the survivors are
+ * compacted to the front. Main thread only.
+ */
+class GestureHistory(
+    val arenaBytes: Int = DEFAULT_ARENA_BYTES,
+    val maxStrokes: Int = DEFAULT_MAX_STROKES,
+    val unitsPerPx: Int = DEFAULT_UNITS_PER_PX,
+) {
+    // Needed for Swift interop — KMM doesn't export default param values to ObjC/Swift
+    constructor() : this(DEFAULT_ARENA_BYTES)
+
+    private val arena = ByteArray(arenaBytes)
+    private var end = 0
+    private var scratch = ByteArray(256)
+    private var clock = 0L
+
+    // Stroke table; `order` lists used slots oldest-recorded first.
+    private val ids = arrayOfNulls<String>(maxStrokes)
+    private val offsets = IntArray(maxStrokes)
+    private val lengths = IntArray(maxStrokes)
+    private val counts = IntArray(maxStrokes)
+    private val lastUsed = LongArray(maxStrokes)
+    private val order = IntArray(maxStrokes)
+
+    /** Number of strokes held. */
+    var size = 0
+        private set
+
+    /** Arena bytes taken by the strokes held. */
+    val usedBytes: Int
+        get() {
+            var used = 0
+            for (k in 0 until size) used += lengths[order[k]]
+            return used
+        }
+
+    /**
+     * Compresses [points] as stroke [sessionId], evicting least recently used
+     * strokes as needed. Returns false if the stroke is empty or larger than
+     * the whole arena.
+     */
+    fun record(sessionId: String, points: PointView): Boolean {
+        if (points.size == 0 || maxStrokes == 0) return false
+        val length = encode(points)
+        if (length > arenaBytes) return false
+        if (size == maxStrokes) evict(leastRecentlyUsed())
+        if (end + length > arenaBytes) {
+            while (arenaBytes - usedBytes < length) evict(leastRecentlyUsed())
+            compact()
+        }
+        val slot = ids.indexOfFirst { it == null }
+        scratch.copyInto(arena, end, 0, length)
+        ids[slot] = sessionId
+        offsets[slot] = end
+        lengths[slot] = length
+        counts[slot] = points.size
+        lastUsed[slot] = ++clock
+        order[size++] = slot
+        end += length
+        return true
+    }
+
+    /**
+     * The [index]th stroke held, oldest first. The returned view decodes
+     * in place and stays valid until the next [record] or [clear].
+     */
+    fun strokeAt(index: Int): HistoryStroke {
+        if (index !in 0 until size) throw IndexOutOfBoundsException("index $index, size $size")
+        return open(order[index])
+    }
+
+    /** The stroke recorded as [sessionId], or null if it was never recorded or was evicted. */
+    fun find(sessionId: String): HistoryStroke? {
+        for (k in 0 until size) {
+            if (ids[order[k]] == sessionId) return open(order[k])
+        }
+        return null
+    }
+
+    fun clear() {
+        ids.fill(null)
+        size = 0
+        end = 0
+    }
+
+    private fun open(slot: Int): HistoryStroke {
+        lastUsed[slot] = ++clock
+        return HistoryStroke(ids[slot]!!, counts[slot], arena, offsets[slot], unitsPerPx)
+    }
+
+    private fun leastRecentlyUsed(): Int {
+        var best = order[0]
+        for (k in 1 until size) {
+            if (lastUsed[order[k]] < lastUsed[best]) best = order[k]
+        }
+        return best
+    }
+
+    private fun evict(slot: Int) {
+        ids[slot] = null
+        val k = (0 until size).first { order[it] == slot }
+        order.copyInto(order, k, k + 1, size)
+        size--
+    }
+
+    /** Slides the held strokes down over the gaps evictions left, keeping arena order. */
+    private fun compact() {
+        val byOffset = order.copyOf(size)
+        val sorted = byOffset.sortedBy { offsets[it] }
+        var to = 0
+        for (slot in sorted) {
+            val from = offsets[slot]
+            if (from != to) arena.copyInto(arena, to, from, from + lengths[slot])
+            offsets[slot] = to
+            to += lengths[slot]
+        }
+        end = to
+    }
+
+    /** Encodes [points] into [scratch]; returns the byte count. */
+    private fun encode(points: PointView): Int {
+        val worstCase = Varint.MAX_BYTES * 3 + (points.size - 1) * (2 * (2 + Varint.MAX_BYTES) + Varint.MAX_BYTES)
+        if (scratch.size < worstCase) scratch = ByteArray(max(worstCase, scratch.size * 2))
+        var qx = quantize(points.x(0))
+        var qy = quantize(points.y(0))
+        var t = points.tMillis(0)
+        var pos = Varint.write(Varint.zigzag(qx.toLong()), scratch, 0)
+        pos = Varint.write(Varint.zigzag(qy.toLong()), scratch, pos)
+        pos = Varint.write(Varint.zigzag(t), scratch, pos)
+        for (i in 1 until points.size) {
+            val nx = quantize(points.x(i))
+            val ny = quantize(points.y(i))
+            val nt = points.tMillis(i)
+            pos = writeDelta(nx - qx, pos)
+            pos = writeDelta(ny - qy, pos)
+            pos = Varint.write(Varint.zigzag(nt - t), scratch, pos)
+            qx = nx
+            qy = ny
+            t = nt
+        }
+        return pos
+    }
+
+    // Little-endian int16; out-of-range deltas escape to a zigzag varint.
+    private fun writeDelta(delta: Int, offset: Int): Int {
+        val short = if (delta > Short.MIN_VALUE && delta <= Short.MAX_VALUE) delta else ESCAPE
+        scratch[offset] = short.toByte()
+        scratch[offset + 1] = (short shr 8).toByte()
+        if (short != ESCAPE) return offset + 2
+        return Varint.write(Varint.zigzag(delta.toLong()), scratch, offset + 2)
+    }
+
+    private fun quantize(v: Float): Int = (v * unitsPerPx).roundToInt()
+
+    companion object {
+        const val DEFAULT_ARENA_BYTES = 64 * 1024
+        const val DEFAULT_MAX_STROKES = 64
+        const val DEFAULT_UNITS_PER_PX = 8
+        internal const val ESCAPE = Short.MIN_VALUE.toInt()
+    }
+}
+
+/**
+ * A stroke held by a [GestureHistory], decoded straight from its arena.
+ *
+ * Reading points in ascending order decodes each one once; stepping back
+ * restarts from the first point. No point list is materialized unless
+ * [toList] is called.
+ */
+class HistoryStroke internal constructor(
+    val sessionId: String,
+    override val size: Int,
+    private val arena: ByteArray,
+    private val offset: Int,
+    private val unitsPerPx: Int,
+) : PointView {
+    private var index = -1
+    private var pos = 0
+    private var qx = 0L
+    private var qy = 0L
+    private var t = 0L
+
+    override fun x(index: Int): Float {
+        seek(index)
+        return qx.toFloat() / unitsPerPx
+    }
+
+    override fun y(index: Int): Float {
+        seek(index)
+        return qy.toFloat() / unitsPerPx
+    }
+
+    override fun tMillis(index: Int): Long {
+        seek(index)
+        return t
+    }
+
+    private fun seek(target: Int) {
+        if (target !in 0 until size) throw IndexOutOfBoundsException("index $target, size $size")
+        if (target < index) index = -1
+        if (index < 0) {
+            pos = offset
+            qx = Varint.unzigzag(readVarint())
+            qy = Varint.unzigzag(readVarint())
+            t = Varint.unzigzag(readVarint())
+            index = 0
+        }
+        while (index < target) {
+            qx += readDelta()
+            qy += readDelta()
+            t += Varint.unzigzag(readVarint())
+            index++
+        }
+    }
+
+    private fun readDelta(): Long {
+        val short = ((arena[pos].toInt() and 0xFF) or (arena[pos + 1].toInt() shl 8)).toShort().toInt()
+        pos += 2
+        return if (short == GestureHistory.ESCAPE) Varint.unzigzag(readVarint()) else short.toLong()
+    }
+
+    private fun readVarint(): Long {
+        var result = 0L
+        var shift = 0
+        while (true) {
+            val b = arena[pos++].toInt()
+            result = result or ((b and 0x7F).toLong() shl shift)
+            if (b and 0x80 == 0) return result
+            shift += 7
+        }
+    }
+}
@@ -4,4 +4,6 @@ data class GestureMatch(
     val type: GestureType,
     val score: Float,
     val algorithm: String,
+    /** Name of the matched template, when the recognizer is template-based. */
+    val templateName: String? = null,
 )
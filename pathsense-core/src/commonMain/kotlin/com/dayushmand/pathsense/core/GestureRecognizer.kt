@@ -1,5 +1,20 @@
 package com.dayushmand.pathsense.core
 
+/**
+ * Scores strokes against a set of gestures.
+ *
+ * Calls come from background analysis workers, never the main thread, and
+ * recognizers may run in parallel with each other. A single recognizer is
+ * never called concurrently with itself, so it may reuse scratch state
+ * across calls; it must not assume every call happens on the same thread.
+ */
 fun interface GestureRecognizer {
     fun recognize(points: List<PathPoint>): GestureMatch?
+
+    /**
+     * Scores a stroke that is still being drawn, for early recognition.
+     * Must not assume the stroke is complete or keep state between calls;
+     * return null to opt out.
+     */
+    fun recognizePartial(points: List<PathPoint>): GestureMatch? = null
 }
@@ -0,0 +1,83 @@
+package com.dayushmand.pathsense.core
+
+/**
+ * Constant-velocity Kalman filter, run independently per axis with state
+ * (position, velocity) and white-noise acceleration. Tracks steady motion
+ * without the lag of an average, and its velocity estimate drives prediction.
+ */
+internal class KalmanFilter(
+    private val processNoise: Float,
+    private val measurementNoise: Float,
+) : PointFilter {
+    private val x = Axis()
+    private val y = Axis()
+    private var lastT = 0L
+    private var started = false
+
+    override fun reset() {
+        started = false
+    }
+
+    override fun filter(p: PathPoint): PathPoint {
+        if (!started) {
+            started = true
+            lastT = p.tMillis
+            x.start(p.x)
+            y.start(p.y)
+            return p
+        }
+        val dtSec = (p.tMillis - lastT).let { if (it > 0) it / 1000f else DEFAULT_DT_SEC }
+        lastT = p.tMillis
+        return PathPoint(x.step(p.x, dtSec), y.step(p.y, dtSec), p.tMillis)
+    }
+
+    override fun predict(aheadMs: Int): PathPoint? {
+        if (!started) return null
+        val ahead = aheadMs / 1000f
+        return PathPoint(x.position + x.velocity * ahead, y.position + y.velocity * ahead, lastT + aheadMs)
+    }
+
+    private inner class Axis {
+        var position = 0f
+        var velocity = 0f
+
+        // Covariance [[p00, p01], [p01, p11]].
+        private var p00 = 0f
+        private var p01 = 0f
+        private var p11 = 0f
+
+        fun start(z: Float) {
+            position = z
+            velocity = 0f
+            p00 = measurementNoise
+            p01 = 0f
+            p11 = INITIAL_VELOCITY_VARIANCE
+        }
+
+        fun step(z: Float, dt: Float): Float {
+            // Predict: x' = F x, P' = F P Fᵀ + Q.
+            position += velocity * dt
+            val dt2 = dt * dt
+            p00 += dt * (2f * p01 + dt * p11) + processNoise * dt2 * dt / 3f
+            p01 += dt * p11 + processNoise * dt2 / 2f
+            p11 += processNoise * dt
+
+            // Update with the measured position.
+            val s = p00 + measurementNoise
+            val k0 = p00 / s
+            val k1 = p01 / s
+            val residual = z - position
+            position += k0 * residual
+            velocity += k1 * residual
+            p11 -= k1 * p01
+            p01 -= k1 * p00
+            p00 -= k0 * p00
+            return position
+        }
+    }
+
+    private companion object {
+        const val DEFAULT_DT_SEC = 1f / 120f
+        const val INITIAL_VELOCITY_VARIANCE = 1_000_000f
+    }
+}
@@ -0,0 +1,116 @@
+package com.dayushmand.pathsense.core
+
+import kotlin.math.PI
+import kotlin.math.abs
+import kotlin.math.atan2
+import kotlin.math.sqrt
+
+/**
+ * Computes [PathKinematics] in one fused pass over a [PointView]: every
+ * segment is read once and feeds the speed, acceleration, jerk, turning and
+ * length accumulators together. Only the percentiles need a second look, at
+ * a sorted copy of the speeds kept in reusable scratch.
+ *
+ * Not thread-safe; each analysis worker owns one.
+ */
+internal class KinematicsKernel {
+    private var speeds = FloatArray(64)
+    private val bins = IntArray(PathKinematics.TURN_BINS)
+
+    fun compute(points: PointView): PathKinematics {
+        val n = points.size
+        if (speeds.size < n) speeds = FloatArray(n)
+        bins.fill(0)
+
+        var length = 0.0
+        var speedCount = 0
+        var peakSpeed = 0f
+        var peakAcceleration = 0f
+        var peakJerk = 0f
+        var jerkSquares = 0.0
+        var jerkCount = 0
+        var turning = 0.0
+
+        var prevX = if (n > 0) points.x(0) else 0f
+        var prevY = if (n > 0) points.y(0) else 0f
+        var prevT = if (n > 0) points.tMillis(0) else 0L
+        // Last non-degenerate direction, speed sample and acceleration sample.
+        var dirX = 0f
+        var dirY = 0f
+        var hasDir = false
+        var lastSpeed = 0f
+        var hasSpeed = false
+        var lastAcceleration = 0f
+        var hasAcceleration = false
+
+        for (i in 1 until n) {
+            val x = points.x(i)
+            val y = points.y(i)
+            val t = points.tMillis(i)
+            val dx = x - prevX
+            val dy = y - prevY
+            val segment = sqrt(dx * dx + dy * dy)
+            length += segment
+
+            if (segment > 0f) {
+                if (hasDir) {
+                    val angle = atan2(dirX * dy - dirY * dx, dirX * dx + dirY * dy)
+                    turning += abs(angle)
+                    val bin = ((angle + PI.toFloat()) / (2f * PI.toFloat()) * PathKinematics.TURN_BINS).toInt()
+                    bins[bin.coerceIn(0, PathKinematics.TURN_BINS - 1)]++
+                }
+                dirX = dx
+                dirY = dy
+                hasDir = true
+            }
+
+            val dtSec = (t - prevT) / 1000f
+            if (dtSec > 0f) {
+                val speed = segment / dtSec
+                speeds[speedCount++] = speed
+                if (speed > peakSpeed) peakSpeed = speed
+                if (hasSpeed) {
+                    val acceleration = (speed - lastSpeed) / dtSec
+                    if (abs(acceleration) > peakAcceleration) peakAcceleration = abs(acceleration)
+                    if (hasAcceleration) {
+                        val jerk = (acceleration - lastAcceleration) / dtSec
+                        if (abs(jerk) > peakJerk) peakJerk = abs(jerk)
+                        jerkSquares += jerk.toDouble() * jerk
+                        jerkCount++
+                    }
+                    lastAcceleration = acceleration
+                    hasAcceleration = true
+                }
+                lastSpeed = speed
+                hasSpeed = true
+            }
+
+            prevX = x
+            prevY = y
+            prevT = t
+        }
+
+        speeds.sort(0, speedCount)
+        val len = length.toFloat()
+        val chord = if (n > 1) MathUtils.distance(points.x(0), points.y(0), points.x(n - 1), points.y(n - 1)) else 0f
+        return PathKinematics(
+            peakSpeed = peakSpeed,
+            medianSpeed = percentile(speedCount, 0.5f),
+            p90Speed = percentile(speedCount, 0.9f),
+            peakAcceleration = peakAcceleration,
+            peakJerk = peakJerk,
+            rmsJerk = if (jerkCount > 0) sqrt(jerkSquares / jerkCount).toFloat() else 0f,
+            totalTurningDeg = (turning * 180.0 / PI).toFloat(),
+            meanCurvature = if (len > 0f) (turning / len).toFloat() else 0f,
+            straightness = if (len > 0f) (chord / len).coerceAtMost(1f) else 1f,
+            turningHistogram = bins.toList(),
+        )
+    }
+
+    // Nearest-rank percentile over the sorted speed scratch.
+    private fun percentile(count: Int, q: Float): Float {
+        if (count == 0) return 0f
+        val rank = (q * count).toInt().coerceIn(0, count - 1)
+        return speeds[rank]
+    }
+}
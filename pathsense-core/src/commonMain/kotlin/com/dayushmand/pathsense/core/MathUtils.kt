@@ -7,7 +7,11 @@ import kotlin.math.sqrt
 
 internal object MathUtils {
     fun distance(a: PathPoint, b: PathPoint): Float {
-        return hypot((b.x - a.x).toDouble(), (b.y - a.y).toDouble()).toFloat()
+        return distance(a.x, a.y, b.x, b.y)
+    }
+
+    fun distance(ax: Float, ay: Float, bx: Float, by: Float): Float {
+        return hypot((bx - ax).toDouble(), (by - ay).toDouble()).toFloat()
     }
 
     fun angleDeg(dx: Float, dy: Float): Float {
@@ -19,4 +23,32 @@ internal object MathUtils {
         for (v in vec) sum += v * v
         return sqrt(sum)
     }
+
+    /** Whether segment a→b touches the rect (Liang–Barsky clipping). */
+    fun segmentIntersectsRect(
+        ax: Float, ay: Float, bx: Float, by: Float,
+        left: Float, top: Float, right: Float, bottom: Float,
+    ): Boolean {
+        val dx = bx - ax
+        val dy = by - ay
+        var t0 = 0f
+        var t1 = 1f
+        for (k in 0 until 4) {
+            val p = when (k) { 0 -> -dx; 1 -> dx; 2 -> -dy; else -> dy }
+            val q = when (k) { 0 -> ax - left; 1 -> right - ax; 2 -> ay - top; else -> bottom - ay }
+            if (p == 0f) {
+                if (q < 0f) return false
+            } else {
+                val r = q / p
+                if (p < 0f) {
+                    if (r > t1) return false
+                    if (r > t0) t0 = r
+                } else {
+                    if (r < t0) return false
+                    if (r < t1) t1 = r
+                }
+            }
+        }
+        return true
+    }
 }
@@ -2,15 +2,29 @@ package com.dayushmand.pathsense.core
 
 import kotlin.math.max
 
-internal fun computeMetrics(points: List<PathPoint>): PathMetrics {
+internal fun computeMetrics(points: List<PathPoint>): PathMetrics = computeMetrics(points.asPointView())
+
+internal fun computeMetrics(points: PointView): PathMetrics {
     if (points.isEmpty()) {
         val zero = PathPoint(0f, 0f, 0L)
         return PathMetrics(0f, RectF(0f, 0f, 0f, 0f), zero, zero, 0f, 0f, 0f, 0f)
     }
-    val length = Resampler.pathLength(points)
-    val bbox = Resampler.boundingBox(points)
-    val start = points.first()
-    val end = points.last()
+    // Length and bounding box in one pass.
+    var length = 0f
+    var minX = points.x(0)
+    var minY = points.y(0)
+    var maxX = minX
+    var maxY = minY
+    for (i in 1 until points.size) {
+        val x = points.x(i)
+        val y = points.y(i)
+        length += MathUtils.distance(points.x(i - 1), points.y(i - 1), x, y)
+        if (x < minX) minX = x else if (x > maxX) maxX = x
+        if (y < minY) minY = y else if (y > maxY) maxY = y
+    }
+    val bbox = RectF(minX, minY, maxX, maxY)
+    val start = points.pointAt(0)
+    val end = points.pointAt(points.size - 1)
     val deltaX = end.x - start.x
     val deltaY = end.y - start.y
     val avgDirectionDeg = MathUtils.angleDeg(deltaX, deltaY)
@@ -0,0 +1,136 @@
+package com.dayushmand.pathsense.core
+
+import kotlin.math.max
+
+/**
+ * Streaming counterpart of [computeMetrics] over a [PointBuffer].
+ *
+ * Path length is kept as a running sum and the bounding box as four monotonic
+ * deques of sequence numbers, so both pushes and FIFO evictions cost amortized
+ * O(1) and [snapshot] never walks the buffer.
+ *
+ * Call [onEvicting] right before adding to a full buffer and [onAppended]
+ * right after every add.
+ */
+internal class MetricsAccumulator(private val buffer: PointBuffer) {
+    private var length = 0.0
+    private val minX = SeqDeque(buffer.capacity)
+    private val maxX = SeqDeque(buffer.capacity)
+    private val minY = SeqDeque(buffer.capacity)
+    private val maxY = SeqDeque(buffer.capacity)
+
+    fun onEvicting() {
+        if (buffer.size >= 2) {
+            length -= MathUtils.distance(buffer.x(0), buffer.y(0), buffer.x(1), buffer.y(1))
+        }
+    }
+
+    fun onAppended() {
+        val last = buffer.size - 1
+        if (last < 0) return
+        push(last)
+    }
+
+    /** Recomputes everything after the buffer was rewritten by [PointBuffer.compact]. */
+    fun rebuild() {
+        reset()
+        for (i in 0 until buffer.size) push(i)
+    }
+
+    private fun push(index: Int) {
+        if (index >= 1) {
+            length += MathUtils.distance(buffer.x(index - 1), buffer.y(index - 1), buffer.x(index), buffer.y(index))
+        } else {
+            length = 0.0
+        }
+        dropEvicted()
+        val seq = buffer.evictedCount + index
+        val x = buffer.x(index)
+        val y = buffer.y(index)
+        while (!minX.isEmpty() && xOf(minX.back()) >= x) minX.popBack()
+        while (!maxX.isEmpty() && xOf(maxX.back()) <= x) maxX.popBack()
+        while (!minY.isEmpty() && yOf(minY.back()) >= y) minY.popBack()
+        while (!maxY.isEmpty() && yOf(maxY.back()) <= y) maxY.popBack()
+        minX.pushBack(seq)
+        maxX.pushBack(seq)
+        minY.pushBack(seq)
+        maxY.pushBack(seq)
+    }
+
+    fun reset() {
+        length = 0.0
+        minX.clear()
+        maxX.clear()
+        minY.clear()
+        maxY.clear()
+    }
+
+    fun snapshot(): PathMetrics {
+        if (buffer.isEmpty()) return computeMetrics(buffer)
+        dropEvicted()
+
+        val start = buffer.pointAt(0)
+        val end = buffer.pointAt(buffer.size - 1)
+        val bbox = RectF(xOf(minX.front()), yOf(minY.front()), xOf(maxX.front()), yOf(maxY.front()))
+        val len = length.toFloat().coerceAtLeast(0f)
+        val deltaX = end.x - start.x
+        val deltaY = end.y - start.y
+        val avgDirectionDeg = MathUtils.angleDeg(deltaX, deltaY)
+        val durationMs = max(1L, end.tMillis - start.tMillis)
+        val avgSpeed = len / (durationMs / 1000f)
+        return PathMetrics(len, bbox, start, end, avgDirectionDeg, avgSpeed, deltaX, deltaY)
+    }
+
+    private fun dropEvicted() {
+        val head = buffer.evictedCount
+        minX.dropBefore(head)
+        maxX.dropBefore(head)
+        minY.dropBefore(head)
+        maxY.dropBefore(head)
+    }
+
+    private fun xOf(seq: Long): Float = buffer.x((seq - buffer.evictedCount).toInt())
+
+    private fun yOf(seq: Long): Float = buffer.y((seq - buffer.evictedCount).toInt())
+
+    /** Fixed-capacity double-ended queue of point sequence numbers. */
+    private class SeqDeque(capacity: Int) {
+        private val items = LongArray(capacity.coerceAtLeast(1))
+        private var head = 0
+        private var size = 0
+
+        fun isEmpty(): Boolean = size == 0
+
+        fun front(): Long = items[head]
+
+        fun back(): Long = items[index(size - 1)]
+
+        fun pushBack(seq: Long) {
+            // Evicted entries are dropped before every push, so at most
+            // `capacity` buffered sequence numbers are ever queued.
+            items[index(size)] = seq
+            size++
+        }
+
+        fun popBack() {
+            size--
+        }
+
+        fun dropBefore(seq: Long) {
+            while (size > 0 && items[head] < seq) {
+                head = index(1)
+                size--
+            }
+        }
+
+        fun clear() {
+            head = 0
+            size = 0
+        }
+
+        private fun index(offset: Int): Int {
+            val i = head + offset
+            return if (i >= items.size) i - items.size else i
+        }
+    }
+}
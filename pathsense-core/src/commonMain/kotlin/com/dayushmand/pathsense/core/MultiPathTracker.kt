@@ -0,0 +1,148 @@
+package com.dayushmand.pathsense.core
+
+/**
+ * Tracks up to [maxPointers] concurrent pointers — pinches, two-finger and
+ * whole-hand gestures — each as its own path with its own session id.
+ *
+ * Per-pointer sessions are preallocated and reused, and all of them share one
+ * [AnalysisEngine] mailbox, so a pointer-down allocates no buffers and starts no
+ * coroutines. Pointers beyond [maxPointers] are ignored. Feed it on the main
+ * thread; events arrive on the main thread tagged with their pointer id.
+ */
+class MultiPathTracker(
+    private val config: PathConfig = PathConfig(),
+    val maxPointers: Int = DEFAULT_MAX_POINTERS,
+) {
+    // Needed for Swift interop — KMM doesn't export default param values to ObjC/Swift
+    constructor() : this(PathConfig())
+
+    var listener: (pointerId: Int, event: PathEvent) -> Unit = { _, _ -> }
+
+    /** Templates matched by the built-in $1 recognizer, shared by all pointers. */
+    val templates: TemplateLibrary = TemplateLibrary.withDefaults()
+
+    /** Finished strokes of every pointer, compressed; null unless [PathConfig.historyBytes] is set. */
+    val history: GestureHistory? = if (config.historyBytes > 0) GestureHistory(config.historyBytes) else null
+
+    private val sessions = Array(maxPointers) { PathSession(config) }
+    private val pointerIds = IntArray(maxPointers) { NO_POINTER }
+    private val analyzer = GestureAnalyzer(config)
+    private val mailbox = AnalysisMailbox(maxPointers) { slot, pointerId, snapshot ->
+        analyzer.analyze(snapshot, sessions[slot]) { listener(pointerId, it) }
+    }
+    private var closed = false
+
+    init {
+        analyzer.add(DollarOneRecognizer(templates))
+    }
+
+    /** Number of pointers currently being tracked. */
+    val activePointerCount: Int
+        get() = pointerIds.count { it != NO_POINTER }
+
+    /** Live, copy-free view of [pointerId]'s points, or null if untracked; main thread only. */
+    fun pointsFor(pointerId: Int): PointView? {
+        val slot = slotOf(pointerId)
+        return if (slot >= 0) sessions[slot].buffer else null
+    }
+
+    fun addRecognizer(r: GestureRecognizer) {
+        analyzer.add(r)
+    }
+
+    fun removeRecognizer(r: GestureRecognizer) {
+        analyzer.remove(r)
+    }
+
+    fun onDown(pointerId: Int, p: PathPoint) {
+        if (closed) return
+        var slot = slotOf(pointerId)
+        if (slot < 0) slot = slotOf(NO_POINTER)
+        if (slot < 0) return
+        pointerIds[slot] = pointerId
+        val session = sessions[slot]
+        val smoothed = session.start(p)
+        val id = session.id ?: return
+
+        listener(pointerId, PathEvent.Started(id, smoothed))
+        listener(pointerId, session.update(id))
+        mailbox.postLive(slot, pointerId, session.liveSnapshot(id))
+    }
+
+    fun onMove(pointerId: Int, p: PathPoint) {
+        val slot = slotOf(pointerId)
+        if (slot < 0) return
+        val session = sessions[slot]
+        val id = session.id ?: return
+        if (!session.move(p)) return
+
+        listener(pointerId, session.update(id))
+        mailbox.postLive(slot, pointerId, session.liveSnapshot(id))
+    }
+
+    /** Batched [onMove] for one pointer; see [PathTracker.onMoveBatch]. */
+    fun onMoveBatch(pointerId: Int, xs: FloatArray, ys: FloatArray, tNanos: LongArray, count: Int) {
+        val slot = slotOf(pointerId)
+        if (slot < 0) return
+        val session = sessions[slot]
+        val id = session.id ?: return
+        if (session.moveBatch(xs, ys, tNanos, count) == 0) return
+
+        listener(pointerId, session.update(id))
+        mailbox.postLive(slot, pointerId, session.liveSnapshot(id))
+    }
+
+    fun onUp(pointerId: Int, p: PathPoint) {
+        val slot = slotOf(pointerId)
+        if (slot < 0) return
+        val session = sessions[slot]
+        pointerIds[slot] = NO_POINTER
+        val id = session.id ?: return
+        val copy = session.end(p)
+        history?.record(id, session.buffer)
+
+        listener(pointerId, PathEvent.Ended(id, copy))
+        mailbox.postFinal(slot, pointerId, session.finalSnapshot(id, copy))
+    }
+
+    fun onCancel(pointerId: Int) {
+        val slot = slotOf(pointerId)
+        if (slot < 0) return
+        pointerIds[slot] = NO_POINTER
+        val id = sessions[slot].cancel() ?: return
+        listener(pointerId, PathEvent.Cancelled(id))
+    }
+
+    /** Cancels every tracked pointer, e.g. on `ACTION_CANCEL`. */
+    fun onCancelAll() {
+        for (slot in pointerIds.indices) {
+            val pointerId = pointerIds[slot]
+            if (pointerId != NO_POINTER) onCancel(pointerId)
+        }
+    }
+
+    private fun slotOf(pointerId: Int): Int {
+        for (slot in pointerIds.indices) {
+            if (pointerIds[slot] == pointerId) return slot
+        }
+        return -1
+    }
+
+    /** Releases the tracker like [PathTracker.close]; input afterwards is ignored. */
+    fun close() {
+        if (closed) return
+        closed = true
+        mailbox.close()
+        for (slot in sessions.indices) {
+            sessions[slot].cancel()
+            sessions[slot].clear()
+            pointerIds[slot] = NO_POINTER
+        }
+        listener = { _, _ -> }
+    }
+
+    companion object {
+        const val DEFAULT_MAX_POINTERS = 10
+        private const val NO_POINTER = Int.MIN_VALUE
+    }
+}
@@ -0,0 +1,73 @@
+package com.dayushmand.pathsense.core
+
+import kotlin.math.PI
+import kotlin.math.abs
+
+/**
+ * One Euro filter (Casiez et al., CHI 2012): a low-pass whose cutoff rises
+ * with speed, so slow movement is steadied while fast movement stays
+ * responsive with little lag. Its smoothed velocity drives prediction.
+ */
+internal class OneEuroFilter(
+    private val minCutoffHz: Float,
+    private val beta: Float,
+    private val derivativeCutoffHz: Float,
+) : PointFilter {
+    private val x = Axis()
+    private val y = Axis()
+    private var lastT = 0L
+    private var started = false
+
+    override fun reset() {
+        started = false
+    }
+
+    override fun filter(p: PathPoint): PathPoint {
+        if (!started) {
+            started = true
+            lastT = p.tMillis
+            x.start(p.x)
+            y.start(p.y)
+            return p
+        }
+        val dtSec = (p.tMillis - lastT).let { if (it > 0) it / 1000f else DEFAULT_DT_SEC }
+        lastT = p.tMillis
+        return PathPoint(x.step(p.x, dtSec), y.step(p.y, dtSec), p.tMillis)
+    }
+
+    override fun predict(aheadMs: Int): PathPoint? {
+        if (!started) return null
+        val ahead = aheadMs / 1000f
+        return PathPoint(x.value + x.velocity * ahead, y.value + y.velocity * ahead, lastT + aheadMs)
+    }
+
+    private inner class Axis {
+        var value = 0f
+        var velocity = 0f
+        private var lastRaw = 0f
+
+        fun start(v: Float) {
+            value = v
+            velocity = 0f
+            lastRaw = v
+        }
+
+        fun step(raw: Float, dtSec: Float): Float {
+            val rawVelocity = (raw - lastRaw) / dtSec
+            lastRaw = raw
+            velocity += alpha(derivativeCutoffHz, dtSec) * (rawVelocity - velocity)
+            val cutoff = minCutoffHz + beta * abs(velocity)
+            value += alpha(cutoff, dtSec) * (raw - value)
+            return value
+        }
+    }
+
+    private fun alpha(cutoffHz: Float, dtSec: Float): Float {
+        val tau = 1f / (2f * PI.toFloat() * cutoffHz)
+        return 1f / (1f + tau / dtSec)
+    }
+
+    private companion object {
+        const val DEFAULT_DT_SEC = 1f / 120f
+    }
+}
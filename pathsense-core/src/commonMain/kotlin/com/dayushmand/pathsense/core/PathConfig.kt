@@ -6,4 +6,77 @@ data class PathConfig(
     val smoothingWindow: Int = 3,
     val resampleSpacingPx: Float = 6f,
     val maxPoints: Int = 500,
+    /** [UpdateMode.DELTA] avoids copying the whole path per move; opt in once listeners handle `Appended`. */
+    val updateMode: UpdateMode = UpdateMode.SNAPSHOT,
+    /** Score at which a stroke still in progress emits [PathEvent.GesturePredicted]; 0 disables. */
+    val earlyRecognitionThreshold: Float = 0f,
+    /** Score at which recognition stops waiting for slower recognizers and reports the match. */
+    val recognitionGoodEnoughScore: Float = 0.95f,
+    /** Record per-stage latency histograms and drop counters; see [PathTracker.statsSnapshot]. */
+    val collectStats: Boolean = false,
+    val overflowPolicy: OverflowPolicy = OverflowPolicy.EVICT_OLDEST,
+    val smoothing: SmoothingFilter = SmoothingFilter.MovingAverage,
+    /** How far ahead [PathTracker.predictedPoint] extrapolates the finger; 0 disables. */
+    val predictionMs: Int = 0,
+    /**
+     * Cell size of the uniform grid that indexes the live path and registered
+     * regions for hit-testing; 0 disables it and queries scan linearly.
+     */
+    val spatialCellPx: Float = 0f,
+    /** Add [PathKinematics] to every `MetricsUpdated`/`MetricsEnded`; computed on the analysis worker. */
+    val kinematics: Boolean = false,
+    /** Arena size of the tracker's [GestureHistory] of finished strokes; 0 keeps no history. */
+    val historyBytes: Int = 0,
 )
+
+/** Filter applied to each accepted point before it is stored. */
+sealed class SmoothingFilter {
+    /** Store raw input. */
+    object None : SmoothingFilter()
+
+    /** 3-point moving average, on when `smoothingWindow >= 3`; about one sample of lag. */
+    object MovingAverage : SmoothingFilter()
+
+    /**
+     * One Euro filter: the cutoff rises from [minCutoffHz] by [beta] per px/s of
+     * speed, steadying slow movement while keeping fast strokes nearly lag-free.
+     */
+    data class OneEuro(
+        val minCutoffHz: Float = 1.5f,
+        val beta: Float = 0.01f,
+        val derivativeCutoffHz: Float = 1f,
+    ) : SmoothingFilter()
+
+    /**
+     * Constant-velocity Kalman filter. [processNoise] is the acceleration noise
+     * density (px²/s³), [measurementNoise] the input variance (px²).
+     */
+    data class Kalman(
+        val processNoise: Float = 500_000f,
+        val measurementNoise: Float = 4f,
+    ) : SmoothingFilter()
+}
+
+/** What [PathTracker] does when a path outgrows [PathConfig.maxPoints]. */
+enum class OverflowPolicy {
+    /** Drop the oldest point; long strokes lose their beginning. */
+    EVICT_OLDEST,
+
+    /**
+     * Keep the whole stroke within the budget: moves are thinned to
+     * `resampleSpacingPx` on ingest, and a full buffer is simplified
+     * (Visvalingam–Whyatt) down to three quarters of `maxPoints`, dropping the
+     * points that contribute least to the shape. Each compaction is reported
+     * like an eviction of every point followed by re-appending the survivors.
+     */
+    DECIMATE,
+}
+
+/** How [PathTracker] reports newly accepted points while a path is in progress. */
+enum class UpdateMode {
+    /** Emit [PathEvent.Appended] carrying only the new points plus buffer version. */
+    DELTA,
+
+    /** Emit [PathEvent.Updated] carrying a full copy of the buffer on every point. */
+    SNAPSHOT,
+}
@@ -3,9 +3,41 @@ package com.dayushmand.pathsense.core
 sealed class PathEvent {
     data class Started(val sessionId: String, val point: PathPoint) : PathEvent()
     data class Updated(val sessionId: String, val points: List<PathPoint>) : PathEvent()
+
+    /**
+     * Delta form of [Updated], emitted in [UpdateMode.DELTA].
+     *
+     * [points] are the newly appended points, with sequence numbers
+     * `version - points.size` until [version]. Points with sequence numbers
+     * below [evictedCount] have left the buffer; a consumer mirroring the path
+     * drops those and appends [points] to stay in sync without a full copy.
+     */
+    data class Appended(
+        val sessionId: String,
+        val points: List<PathPoint>,
+        val version: Long,
+        val evictedCount: Long,
+    ) : PathEvent()
+
     data class MetricsUpdated(val sessionId: String, val metrics: PathMetrics) : PathEvent()
     data class Ended(val sessionId: String, val points: List<PathPoint>) : PathEvent()
     data class MetricsEnded(val sessionId: String, val metrics: PathMetrics) : PathEvent()
     data class GestureRecognized(val sessionId: String, val match: GestureMatch) : PathEvent()
+
+    /**
+     * Provisional match for a stroke still in progress, emitted once its score
+     * reaches [PathConfig.earlyRecognitionThreshold] and again only if the
+     * predicted gesture changes. [GestureRecognized] still follows the lift.
+     */
+    data class GesturePredicted(val sessionId: String, val match: GestureMatch) : PathEvent()
+
+    /**
+     * The path touched a region registered with [PathTracker.addRegion]. A
+     * segment that passes straight through reports [RegionExited] right after.
+     */
+    data class RegionEntered(val sessionId: String, val regionId: String) : PathEvent()
+
+    /** The path left the region, or lifted while inside it. */
+    data class RegionExited(val sessionId: String, val regionId: String) : PathEvent()
     data class Cancelled(val sessionId: String) : PathEvent()
 }
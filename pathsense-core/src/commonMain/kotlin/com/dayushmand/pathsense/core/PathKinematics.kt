@@ -0,0 +1,33 @@
+package com.dayushmand.pathsense.core
+
+/**
+ * Extended motion metrics, present in [PathMetrics.kinematics] when
+ * [PathConfig.kinematics] is on. Speeds are px/s, accelerations px/s², jerk
+ * px/s³ and curvature rad/px; segments with no elapsed time add geometry only.
+ */
+data class PathKinematics(
+    val peakSpeed: Float,
+    val medianSpeed: Float,
+    val p90Speed: Float,
+    /** Largest change in speed between consecutive segments, per second. */
+    val peakAcceleration: Float,
+    val peakJerk: Float,
+    /** Root mean square jerk; lower reads as smoother movement. */
+    val rmsJerk: Float,
+    /** Sum of absolute turning angles, in degrees. */
+    val totalTurningDeg: Float,
+    /** Absolute turning per unit length. */
+    val meanCurvature: Float,
+    /** Start-to-end distance over path length: 1 for a straight line, near 0 for a loop. */
+    val straightness: Float,
+    /**
+     * Counts of signed turning angles between consecutive segments, in
+     * [TURN_BINS] equal bins from -180° to 180°; negative turns are
+     * counter-clockwise on screen.
+     */
+    val turningHistogram: List<Int>,
+) {
+    companion object {
+        const val TURN_BINS = 8
+    }
+}
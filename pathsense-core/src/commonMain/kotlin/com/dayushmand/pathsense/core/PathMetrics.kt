@@ -9,4 +9,6 @@ data class PathMetrics(
     val avgSpeed: Float,
     val deltaX: Float,
     val deltaY: Float,
+    /** Extended motion metrics; null unless [PathConfig.kinematics]. */
+    val kinematics: PathKinematics? = null,
 )
@@ -0,0 +1,245 @@
+package com.dayushmand.pathsense.core
+
+import kotlin.math.max
+import kotlin.math.roundToLong
+import kotlin.random.Random
+
+/**
+ * State of one path in progress: the smoothed point ring, its streaming
+ * metrics and the early-recognition candidate.
+ *
+ * Sessions are preallocated and reused stroke after stroke, so starting a
+ * path allocates no buffers. Main thread only.
+ */
+internal class PathSession(
+    private val config: PathConfig,
+    private val stats: StatsRecorder? = null,
+) {
+    val buffer = PointBuffer(config.maxPoints)
+    val metrics = MetricsAccumulator(buffer)
+    private val candidate = StreamingResampler(config.resampleSpacingPx, config.maxPoints)
+    private val intervalMs = max(1, (1000f / config.samplingHz).roundToLong())
+    private val intervalNanos = NANOS_PER_SECOND / max(1, config.samplingHz)
+    private val simplifier =
+        if (config.overflowPolicy == OverflowPolicy.DECIMATE) PathSimplifier(buffer.capacity) else null
+    private val filter = PointFilter.create(config)
+    private val grid = if (config.spatialCellPx > 0f) SegmentGrid(config.spatialCellPx, buffer) else null
+    private val liveColumns = if (config.kinematics) SharedPointBuffer(buffer.capacity) else null
+    val regions = RegionWatcher(config.spatialCellPx)
+
+    /** Region enter/exit events raised by accepted points, for the owner to dispatch. */
+    val regionEvents = ArrayList<PathEvent>()
+    private val minSpacingPx =
+        if (simplifier != null) max(config.minDistancePx, config.resampleSpacingPx) else config.minDistancePx
+
+    /** Id of the path in progress, or null between strokes. */
+    var id: String? = null
+        private set
+
+    /** Where the finger is expected `predictionMs` past the last point, or null. */
+    var predictedPoint: PathPoint? = null
+        private set
+
+    // Last GesturePredicted for this slot, to suppress repeats; analysis worker only.
+    var predictedFor: String? = null
+    var predicted: GestureMatch? = null
+
+    private var emittedVersion = 0L
+    private var predictedAtSamples = 0
+    private var lastSampleNanos = 0L
+    private var lastAccepted: PathPoint? = null
+
+    val isActive: Boolean
+        get() = id != null
+
+    fun clear() {
+        buffer.clear()
+        metrics.reset()
+        grid?.clear()
+        liveColumns?.reset(id)
+        regions.reset()
+        regionEvents.clear()
+        candidate.reset()
+        predictedAtSamples = 0
+        filter.reset()
+        predictedPoint = null
+        lastAccepted = null
+    }
+
+    /** Starts a new path at [p]; returns the smoothed first point. */
+    fun start(p: PathPoint): PathPoint {
+        id = newSessionId()
+        clear()
+        return accept(p)
+    }
+
+    /** Feeds a move; returns false if throttled by rate or distance. */
+    fun move(p: PathPoint): Boolean {
+        if (id == null) return false
+        val tNanos = p.tMillis * NANOS_PER_MILLI
+        if (!passesGates(p.x, p.y, tNanos, intervalMs * NANOS_PER_MILLI)) return false
+        accept(p, tNanos)
+        return true
+    }
+
+    /**
+     * Feeds [count] moves from primitive columns with nanosecond timestamps,
+     * gating the rate at full precision; returns how many were accepted.
+     */
+    fun moveBatch(xs: FloatArray, ys: FloatArray, tNanos: LongArray, count: Int): Int {
+        if (id == null) return 0
+        var accepted = 0
+        for (i in 0 until count) {
+            val t = tNanos[i]
+            if (!passesGates(xs[i], ys[i], t, intervalNanos)) continue
+            accept(PathPoint(xs[i], ys[i], t / NANOS_PER_MILLI), t)
+            accepted++
+        }
+        return accepted
+    }
+
+    private fun passesGates(x: Float, y: Float, tNanos: Long, minIntervalNanos: Long): Boolean {
+        val last = lastAccepted ?: return true
+        if (tNanos - lastSampleNanos < minIntervalNanos) {
+            stats?.onRejectedByRate()
+            return false
+        }
+        if (MathUtils.distance(last.x, last.y, x, y) < minSpacingPx) {
+            stats?.onRejectedByDistance()
+            return false
+        }
+        return true
+    }
+
+    /** Ends the path at [p]; returns a copy of its points. */
+    fun end(p: PathPoint): List<PathPoint> {
+        accept(p)
+        id?.let { regions.exitAll(it, regionEvents) }
+        emittedVersion = buffer.version
+        id = null
+        predictedPoint = null
+        return buffer.toList()
+    }
+
+    /** Drops the path in progress; returns its id, or null if none. */
+    fun cancel(): String? {
+        val cancelled = id ?: return null
+        clear()
+        id = null
+        return cancelled
+    }
+
+    /** [PathEvent.Appended] or [PathEvent.Updated] for points accepted since the last call. */
+    fun update(id: String): PathEvent {
+        val event = when (config.updateMode) {
+            UpdateMode.SNAPSHOT -> PathEvent.Updated(id, buffer.toList())
+            UpdateMode.DELTA -> {
+                val version = buffer.version
+                val evicted = buffer.evictedCount
+                val from = (max(emittedVersion, evicted) - evicted).toInt()
+                val appended = List(buffer.size - from) { buffer.pointAt(from + it) }
+                PathEvent.Appended(id, appended, version, evicted)
+            }
+        }
+        emittedVersion = buffer.version
+        return event
+    }
+
+    /** Whether any live segment touches [bounds]. */
+    fun crosses(bounds: RectF): Boolean = grid?.crosses(bounds) ?: SegmentGrid.scanCrosses(buffer, bounds)
+
+    /** Index of the point nearest ([x], [y]), or -1 if there are none. */
+    fun nearestIndex(x: Float, y: Float): Int = grid?.nearestIndex(x, y) ?: SegmentGrid.scanNearest(buffer, x, y)
+
+    fun liveSnapshot(id: String): PathSnapshot =
+        PathSnapshot(
+            id,
+            metrics.snapshot(),
+            isFinal = false,
+            points = partialCandidate(),
+            postedNanos = stats?.nanosNow() ?: 0L,
+            liveColumns = liveColumns,
+        )
+
+    fun finalSnapshot(id: String, points: List<PathPoint>): PathSnapshot =
+        PathSnapshot(
+            id,
+            metrics.snapshot(),
+            isFinal = true,
+            points = points,
+            columns = if (config.kinematics) buffer.copyColumns() else null,
+        )
+
+    private fun accept(p: PathPoint, tNanos: Long = p.tMillis * NANOS_PER_MILLI): PathPoint {
+        val smoothed = filter.filter(p)
+        if (config.predictionMs > 0) predictedPoint = filter.predict(config.predictionMs)
+        if (buffer.isFull && simplifier != null) {
+            simplifier.compact(buffer)
+            metrics.rebuild()
+            grid?.rebuild()
+            liveColumns?.mirror(buffer)
+        }
+        // Tiny buffers can't be simplified; fall back to FIFO.
+        if (buffer.isFull) {
+            metrics.onEvicting()
+            grid?.onEvicting()
+        }
+        val previous = lastAccepted ?: smoothed
+        buffer.add(smoothed)
+        liveColumns?.add(smoothed.x, smoothed.y, smoothed.tMillis)
+        metrics.onAppended()
+        grid?.onAppended()
+        val id = id
+        if (id != null && !regions.isEmpty) {
+            regions.onSegment(id, previous.x, previous.y, smoothed.x, smoothed.y, regionEvents)
+        }
+        if (config.earlyRecognitionThreshold > 0f) candidate.add(smoothed.x, smoothed.y, smoothed.tMillis)
+        lastSampleNanos = tNanos
+        lastAccepted = smoothed
+        return smoothed
+    }
+
+    /** Resampled stroke so far, when it has grown enough since the last prediction. */
+    private fun partialCandidate(): List<PathPoint> {
+        if (config.earlyRecognitionThreshold <= 0f) return emptyList()
+        val samples = candidate.size
+        if (samples < PREDICT_MIN_SAMPLES || samples - predictedAtSamples < PREDICT_EVERY_SAMPLES) {
+            return emptyList()
+        }
+        predictedAtSamples = samples
+        return candidate.toList()
+    }
+
+    private fun newSessionId(): String {
+        val time = currentTimeMillis()
+        val rand = Random.nextInt(0, 1_000_000)
+        return "ps-$time-$rand"
+    }
+
+    private companion object {
+        const val NANOS_PER_MILLI = 1_000_000L
+        const val NANOS_PER_SECOND = 1_000_000_000L
+
+        /** Resampled points (at `resampleSpacingPx`) before the first prediction. */
+        const val PREDICT_MIN_SAMPLES = 8
+
+        /** New resampled points between predictions, bounding mid-stroke work. */
+        const val PREDICT_EVERY_SAMPLES = 4
+    }
+}
+
+/** What a session hands the analysis pipeline after each point. */
+internal data class PathSnapshot(
+    val sessionId: String,
+    val metrics: PathMetrics,
+    val isFinal: Boolean,
+    // Final snapshots carry the path; live ones carry a resampled
+    // candidate only when early recognition is due, else O(1) metrics.
+    val points: List<PathPoint> = emptyList(),
+    // StatsRecorder.nanosNow() at posting, when stats are on.
+    val postedNanos: Long = 0L,
+    // Copy of the whole path for the kinematics kernel, when enabled (final snapshots).
+    val columns: PointColumns? = null,
+    // Live snapshots instead point at the session's mirror, copied only when taken.
+    val liveColumns: SharedPointBuffer? = null,
+)
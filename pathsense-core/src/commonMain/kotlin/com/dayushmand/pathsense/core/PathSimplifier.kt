@@ -0,0 +1,117 @@
+package com.dayushmand.pathsense.core
+
+import kotlin.math.abs
+import kotlin.math.max
+
+/**
+ * Visvalingam–Whyatt simplification of a full [PointBuffer], used by
+ * [OverflowPolicy.DECIMATE] in place of FIFO eviction.
+ *
+ * Repeatedly drops the interior point whose triangle with its neighbours has
+ * the smallest area — the point contributing least to the shape — until
+ * [targetSize] remain. Endpoints always survive. A min-heap with lazy
+ * invalidation makes one compaction O(n log n); compacting to well below
+ * capacity amortizes that over many appends. All scratch is preallocated.
+ */
+internal class PathSimplifier(private val capacity: Int) {
+    val targetSize = (capacity - capacity / 4).coerceAtLeast(2)
+
+    private val xs = FloatArray(capacity)
+    private val ys = FloatArray(capacity)
+    private val ts = LongArray(capacity)
+    private val keep = BooleanArray(capacity)
+    private val prev = IntArray(capacity)
+    private val next = IntArray(capacity)
+    private val area = FloatArray(capacity)
+    private val stamp = IntArray(capacity)
+
+    // Heap entries: (area, point, stamp); stale entries are skipped on pop.
+    private val heapArea = FloatArray(capacity * 3)
+    private val heapPoint = IntArray(capacity * 3)
+    private val heapStamp = IntArray(capacity * 3)
+    private var heapSize = 0
+
+    fun compact(buffer: PointBuffer) {
+        val n = buffer.size
+        if (n <= targetSize || n < 3) return
+        for (i in 0 until n) {
+            xs[i] = buffer.x(i)
+            ys[i] = buffer.y(i)
+            ts[i] = buffer.tMillis(i)
+            keep[i] = true
+            prev[i] = i - 1
+            next[i] = i + 1
+            stamp[i] = 0
+        }
+        heapSize = 0
+        for (i in 1 until n - 1) {
+            area[i] = triangle(i - 1, i, i + 1)
+            push(area[i], i, 0)
+        }
+
+        var remaining = n
+        while (remaining > targetSize && heapSize > 0) {
+            val i = heapPoint[0]
+            val s = heapStamp[0]
+            pop()
+            if (!keep[i] || s != stamp[i]) continue
+            keep[i] = false
+            remaining--
+            val p = prev[i]
+            val q = next[i]
+            next[p] = q
+            prev[q] = p
+            // Never let a neighbour's effective area drop below the one just
+            // removed, so removal order stays monotonic.
+            if (p > 0) update(p, max(triangle(prev[p], p, q), area[i]))
+            if (q < n - 1) update(q, max(triangle(p, q, next[q]), area[i]))
+        }
+        buffer.compact(xs, ys, ts, keep, n)
+    }
+
+    private fun update(i: Int, newArea: Float) {
+        area[i] = newArea
+        stamp[i]++
+        push(newArea, i, stamp[i])
+    }
+
+    private fun triangle(a: Int, b: Int, c: Int): Float =
+        abs((xs[b] - xs[a]) * (ys[c] - ys[a]) - (xs[c] - xs[a]) * (ys[b] - ys[a])) * 0.5f
+
+    private fun push(a: Float, point: Int, s: Int) {
+        var i = heapSize++
+        while (i > 0) {
+            val parent = (i - 1) / 2
+            if (heapArea[parent] <= a) break
+            heapArea[i] = heapArea[parent]
+            heapPoint[i] = heapPoint[parent]
+            heapStamp[i] = heapStamp[parent]
+            i = parent
+        }
+        heapArea[i] = a
+        heapPoint[i] = point
+        heapStamp[i] = s
+    }
+
+    private fun pop() {
+        val last = --heapSize
+        if (last == 0) return
+        val a = heapArea[last]
+        val point = heapPoint[last]
+        val s = heapStamp[last]
+        var i = 0
+        while (true) {
+            var child = 2 * i + 1
+            if (child >= last) break
+            if (child + 1 < last && heapArea[child + 1] < heapArea[child]) child++
+            if (heapArea[child] >= a) break
+            heapArea[i] = heapArea[child]
+            heapPoint[i] = heapPoint[child]
+            heapStamp[i] = heapStamp[child]
+            i = child
+        }
+        heapArea[i] = a
+        heapPoint[i] = point
+        heapStamp[i] = s
+    }
+}
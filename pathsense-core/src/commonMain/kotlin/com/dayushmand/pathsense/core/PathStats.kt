@@ -0,0 +1,68 @@
+package com.dayushmand.pathsense.core
+
+/**
+ * Point-in-time copy of a tracker's instrumentation, from
+ * [PathTracker.statsSnapshot]. Cheap to take and safe to ship to telemetry.
+ *
+ * Counters are read without a global lock, so a snapshot taken while points
+ * are flowing may be off by the few samples recorded during the copy.
+ */
+class PathStats internal constructor(
+    /** Wall time of each accepted or rejected `onMove` (or whole `onMoveBatch`), listener included. */
+    val onMove: LatencySnapshot,
+    /** Time spent inside the listener, per event. */
+    val listener: LatencySnapshot,
+    /** Delay from posting a live snapshot to delivering its `MetricsUpdated`. */
+    val metricsDelay: LatencySnapshot,
+    /** Time per `recognize` call, keyed by recognizer class name. */
+    val recognition: Map<String, LatencySnapshot>,
+    /** Live snapshots replaced before the analysis worker picked them up. */
+    val conflatedSnapshots: Long,
+    /** Moves dropped by the `samplingHz` gate. */
+    val rejectedByRate: Long,
+    /** Moves dropped by the `minDistancePx` gate. */
+    val rejectedByDistance: Long,
+    /** Recognizer calls that threw; each counted as no match. */
+    val recognizerFailures: Long,
+) {
+    override fun toString(): String =
+        "PathStats(onMove=$onMove, listener=$listener, metricsDelay=$metricsDelay, " +
+            "recognition=$recognition, conflated=$conflatedSnapshots, " +
+            "rejectedByRate=$rejectedByRate, rejectedByDistance=$rejectedByDistance, " +
+            "recognizerFailures=$recognizerFailures)"
+}
+
+/**
+ * Log₂ latency histogram: bucket `i` counts samples in `[2^(i-1), 2^i)` ns
+ * (bucket 0 holds zero-length samples).
+ */
+class LatencySnapshot internal constructor(
+    val count: Long,
+    val totalNanos: Long,
+    val maxNanos: Long,
+    private val buckets: LongArray,
+) {
+    val bucketCount: Int
+        get() = buckets.size
+
+    val meanNanos: Long
+        get() = if (count == 0L) 0L else totalNanos / count
+
+    fun countInBucket(index: Int): Long = buckets[index]
+
+    /** Upper bound of the bucket holding the [fraction] quantile, e.g. 0.99 for p99. */
+    fun percentileNanos(fraction: Double): Long {
+        if (count == 0L) return 0L
+        val rank = (fraction.coerceIn(0.0, 1.0) * count).toLong().coerceAtLeast(1L)
+        var seen = 0L
+        for (i in buckets.indices) {
+            seen += buckets[i]
+            if (seen >= rank) return if (i == 0) 0L else minOf(1L shl i, maxNanos)
+        }
+        return maxNanos
+    }
+
+    override fun toString(): String =
+        "LatencySnapshot(count=$count, meanNs=$meanNanos, p50Ns=${percentileNanos(0.5)}, " +
+            "p99Ns=${percentileNanos(0.99)}, maxNs=$maxNanos)"
+}
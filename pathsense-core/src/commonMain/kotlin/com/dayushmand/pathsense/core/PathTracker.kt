@@ -1,159 +1,234 @@
 package com.dayushmand.pathsense.core
 
-import kotlinx.coroutines.CoroutineScope
-import kotlinx.coroutines.Dispatchers
-import kotlinx.coroutines.SupervisorJob
-import kotlinx.coroutines.channels.Channel
-import kotlinx.coroutines.launch
-import kotlinx.coroutines.withContext
-import kotlin.math.max
-import kotlin.math.roundToLong
-import kotlin.random.Random
-
 class PathTracker(private val config: PathConfig = PathConfig()) {
     // Needed for Swift interop — KMM doesn't export default param values to ObjC/Swift
     constructor() : this(PathConfig())
 
     var listener: (PathEvent) -> Unit = {}
 
-    private val buffer = PointBuffer(config.maxPoints)
-    private val recognizers = LinkedHashSet<GestureRecognizer>()
-    private val analysisScope = CoroutineScope(SupervisorJob() + Dispatchers.Default)
-    private val snapshots = Channel<Snapshot>(Channel.CONFLATED)
+    /** Templates matched by the built-in $1 recognizer; add or remove at any time. */
+    val templates: TemplateLibrary = TemplateLibrary.withDefaults()
+
+    /** Finished strokes, compressed; null unless [PathConfig.historyBytes] is set. Main thread only. */
+    val history: GestureHistory? = if (config.historyBytes > 0) GestureHistory(config.historyBytes) else null
 
-    private var sessionId: String? = null
-    private var lastSampleTime = 0L
-    private var lastAccepted: PathPoint? = null
-    private var prevSmoothed1: PathPoint? = null
-    private var prevSmoothed2: PathPoint? = null
+    private val stats = if (config.collectStats) StatsRecorder() else null
+    private val session = PathSession(config, stats)
+    private val buffer = session.buffer
+    private val analyzer = GestureAnalyzer(config, stats)
+    private val mailbox = AnalysisMailbox(slots = 1, stats) { _, _, snapshot ->
+        analyzer.analyze(snapshot, session) { dispatch(it) }
+    }
+    private val pointsListeners = ArrayList<() -> Unit>()
+    private val strokeListeners = ArrayList<(PointView) -> Unit>()
+    private var closed = false
 
     init {
-        recognizers.add(DollarOneRecognizer())
-        analysisScope.launch {
-            for (snapshot in snapshots) {
-                val metrics = computeMetrics(snapshot.points)
-                withContext(MainDispatcher) {
-                    if (!snapshot.isFinal) {
-                        listener(PathEvent.MetricsUpdated(snapshot.sessionId, metrics))
-                    } else {
-                        listener(PathEvent.MetricsEnded(snapshot.sessionId, metrics))
-                        val match = recognize(snapshot.points)
-                        if (match != null) {
-                            listener(PathEvent.GestureRecognized(snapshot.sessionId, match))
-                        }
-                    }
-                }
-            }
-        }
+        analyzer.add(DollarOneRecognizer(templates))
     }
 
+    /** Copy of the current (smoothed) points. Prefer [points] on hot paths. */
     val currentPoints: List<PathPoint>
         get() = buffer.toList()
 
+    /** Live, copy-free view of the current (smoothed) points; read on the main thread only. */
+    val points: PointView
+        get() = buffer
+
+    /** Sequence number the next accepted point will get; see [PathEvent.Appended]. */
+    val pointsVersion: Long
+        get() = buffer.version
+
+    /** Sequence number of `points[0]`: how many points have left the buffer so far. */
+    val evictedCount: Long
+        get() = buffer.evictedCount
+
+    /**
+     * Where the finger is expected [PathConfig.predictionMs] past the newest
+     * point, for drawing a provisional tail; null between strokes or when
+     * prediction is off. Main thread only.
+     */
+    val predictedPoint: PathPoint?
+        get() = session.predictedPoint
+
+    /** Copy of the latency histograms and drop counters, or null unless [PathConfig.collectStats]. */
+    fun statsSnapshot(): PathStats? = stats?.snapshot()
+
+    /** Zeroes all stats, e.g. right after shipping a [statsSnapshot]. */
+    fun resetStats() {
+        stats?.reset()
+    }
+
     fun addRecognizer(r: GestureRecognizer) {
-        recognizers.add(r)
+        analyzer.add(r)
     }
 
     fun removeRecognizer(r: GestureRecognizer) {
-        recognizers.remove(r)
+        analyzer.remove(r)
+    }
+
+    /**
+     * Watches [bounds] for the path: [PathEvent.RegionEntered] and
+     * [PathEvent.RegionExited] report it touching and leaving the region.
+     * Re-adding an [id] replaces its bounds. Main thread only.
+     */
+    fun addRegion(id: String, bounds: RectF) {
+        session.regions.add(id, bounds)
+    }
+
+    fun removeRegion(id: String) {
+        session.regions.remove(id)
+    }
+
+    /** Whether the current path touches [bounds]; main thread only. */
+    fun crosses(bounds: RectF): Boolean = session.crosses(bounds)
+
+    /** The current point nearest ([x], [y]), or null if there are none; main thread only. */
+    fun nearestPoint(x: Float, y: Float): PathPoint? {
+        val i = session.nearestIndex(x, y)
+        return if (i >= 0) buffer.pointAt(i) else null
+    }
+
+    /**
+     * Registers [l] to run whenever [points] change: a point accepted, the
+     * stroke ended, cancelled or cleared. Independent of [listener], so a
+     * renderer can redraw without wrapping the app's listener. Main thread only.
+     */
+    fun addPointsListener(l: () -> Unit) {
+        pointsListeners.add(l)
+    }
+
+    fun removePointsListener(l: () -> Unit) {
+        pointsListeners.remove(l)
+    }
+
+    /**
+     * Registers [l] to receive each finished stroke's accepted points, right
+     * after [PathEvent.Ended]. The view is only valid during the call. Like
+     * [addPointsListener], independent of [listener]. Main thread only.
+     */
+    fun addStrokeListener(l: (PointView) -> Unit) {
+        strokeListeners.add(l)
+    }
+
+    fun removeStrokeListener(l: (PointView) -> Unit) {
+        strokeListeners.remove(l)
     }
 
     fun clearPoints() {
-        buffer.clear()
-        prevSmoothed1 = null
-        prevSmoothed2 = null
-        lastAccepted = null
+        session.clear()
+        notifyPointsChanged()
     }
 
     fun onDown(p: PathPoint) {
-        val id = newSessionId()
-        sessionId = id
-        clearPoints()
+        if (closed) return
+        val smoothed = session.start(p)
+        val id = session.id ?: return
+
+        dispatch(PathEvent.Started(id, smoothed))
+        dispatch(session.update(id))
+        dispatchRegionEvents()
+        notifyPointsChanged()
+        mailbox.postLive(0, 0, session.liveSnapshot(id))
+    }
+
+    fun onMove(p: PathPoint) {
+        if (stats == null) {
+            move(p)
+            return
+        }
+        val start = stats.nanosNow()
+        move(p)
+        stats.onMove.record(stats.nanosNow() - start)
+    }
 
-        val smoothed = smooth(p)
-        pushPoint(smoothed)
-        lastSampleTime = p.tMillis
-        lastAccepted = smoothed
+    private fun move(p: PathPoint) {
+        val id = session.id ?: return
+        if (!session.move(p)) return
 
-        listener(PathEvent.Started(id, smoothed))
-        listener(PathEvent.Updated(id, currentPoints))
-        snapshots.trySend(Snapshot(id, currentPoints, isFinal = false))
+        dispatch(session.update(id))
+        dispatchRegionEvents()
+        notifyPointsChanged()
+        mailbox.postLive(0, 0, session.liveSnapshot(id))
     }
 
-    fun onMove(p: PathPoint) {
-        val id = sessionId ?: return
-        val intervalMs = max(1, (1000f / config.samplingHz).roundToLong())
-        val last = lastAccepted
-        if (last != null) {
-            val dt = p.tMillis - lastSampleTime
-            if (dt < intervalMs) return
-            if (MathUtils.distance(last, p) < config.minDistancePx) return
+    /**
+     * Feeds [count] moves at once, e.g. a `MotionEvent` with its history, from
+     * primitive columns with nanosecond timestamps. The rate and distance
+     * gates and smoothing run in one pass and accepted points are reported in
+     * a single `Appended`/`Updated` event and one analysis snapshot.
+     */
+    fun onMoveBatch(xs: FloatArray, ys: FloatArray, tNanos: LongArray, count: Int) {
+        if (stats == null) {
+            moveBatch(xs, ys, tNanos, count)
+            return
         }
+        val start = stats.nanosNow()
+        moveBatch(xs, ys, tNanos, count)
+        stats.onMove.record(stats.nanosNow() - start)
+    }
 
-        val smoothed = smooth(p)
-        pushPoint(smoothed)
-        lastSampleTime = p.tMillis
-        lastAccepted = smoothed
+    private fun moveBatch(xs: FloatArray, ys: FloatArray, tNanos: LongArray, count: Int) {
+        val id = session.id ?: return
+        if (session.moveBatch(xs, ys, tNanos, count) == 0) return
 
-        listener(PathEvent.Updated(id, currentPoints))
-        snapshots.trySend(Snapshot(id, currentPoints, isFinal = false))
+        dispatch(session.update(id))
+        dispatchRegionEvents()
+        notifyPointsChanged()
+        mailbox.postLive(0, 0, session.liveSnapshot(id))
     }
 
     fun onUp(p: PathPoint) {
-        val id = sessionId ?: return
-        val smoothed = smooth(p)
-        pushPoint(smoothed)
-        lastSampleTime = p.tMillis
-        lastAccepted = smoothed
-
-        listener(PathEvent.Ended(id, currentPoints))
-        snapshots.trySend(Snapshot(id, currentPoints, isFinal = true))
-        sessionId = null
+        val id = session.id ?: return
+        val copy = session.end(p)
+        history?.record(id, buffer)
+        dispatch(PathEvent.Ended(id, copy))
+        for (i in strokeListeners.indices.reversed()) strokeListeners[i](buffer)
+        dispatchRegionEvents()
+        notifyPointsChanged()
+        mailbox.postFinal(0, 0, session.finalSnapshot(id, copy))
     }
 
     fun onCancel() {
-        val id = sessionId ?: return
-        clearPoints()
-        listener(PathEvent.Cancelled(id))
-        sessionId = null
-    }
-
-    private fun pushPoint(point: PathPoint) {
-        prevSmoothed2 = prevSmoothed1
-        prevSmoothed1 = point
-        buffer.add(point)
-    }
-
-    private fun smooth(point: PathPoint): PathPoint {
-        if (config.smoothingWindow < 3) return point
-        val p1 = prevSmoothed1
-        val p2 = prevSmoothed2
-        if (p1 == null || p2 == null) return point
-        val x = (p1.x + p2.x + point.x) / 3f
-        val y = (p1.y + p2.y + point.y) / 3f
-        return PathPoint(x, y, point.tMillis)
-    }
-
-    private fun recognize(points: List<PathPoint>): GestureMatch? {
-        var best: GestureMatch? = null
-        for (recognizer in recognizers) {
-            val match = recognizer.recognize(points) ?: continue
-            if (best == null || match.score > best!!.score) {
-                best = match
-            }
-        }
-        return best
+        val id = session.cancel() ?: return
+        dispatch(PathEvent.Cancelled(id))
+        notifyPointsChanged()
+    }
+
+    /**
+     * Releases the tracker: pending analysis is dropped, no further events are
+     * delivered and the listener is cleared. Input after [close] is ignored.
+     */
+    fun close() {
+        if (closed) return
+        closed = true
+        mailbox.close()
+        session.cancel()
+        session.clear()
+        listener = {}
+        pointsListeners.clear()
+        strokeListeners.clear()
+    }
+
+    private fun notifyPointsChanged() {
+        // Backwards, so a listener may remove itself.
+        for (i in pointsListeners.indices.reversed()) pointsListeners[i]()
     }
 
-    private fun newSessionId(): String {
-        val time = currentTimeMillis()
-        val rand = Random.nextInt(0, 1_000_000)
-        return "ps-$time-$rand"
+    private fun dispatchRegionEvents() {
+        val events = session.regionEvents
+        if (events.isEmpty()) return
+        for (i in events.indices) dispatch(events[i])
+        events.clear()
     }
 
-    private data class Snapshot(
-        val sessionId: String,
-        val points: List<PathPoint>,
-        val isFinal: Boolean,
-    )
+    private fun dispatch(event: PathEvent) {
+        if (stats == null) {
+            listener(event)
+            return
+        }
+        val start = stats.nanosNow()
+        listener(event)
+        stats.listener.record(stats.nanosNow() - start)
+    }
 }
@@ -1,24 +1,161 @@
 package com.dayushmand.pathsense.core
 
-internal class PointBuffer(private val maxPoints: Int) {
-    private val deque = ArrayDeque<PathPoint>()
+import kotlinx.atomicfu.locks.SynchronizedObject
+import kotlinx.atomicfu.locks.synchronized
 
-    val size: Int
-        get() = deque.size
+/**
+ * Fixed-capacity FIFO ring buffer stored as parallel primitive columns.
+ *
+ * Points are never boxed on the write path; the buffer itself is the
+ * [PointView] handed to metrics and renderers, so reading it costs no copy.
+ */
+internal class PointBuffer(maxPoints: Int) : PointView {
+    val capacity = maxPoints.coerceAtLeast(0)
+    private val xs = FloatArray(capacity)
+    private val ys = FloatArray(capacity)
+    private val ts = LongArray(capacity)
+    private var head = 0
+
+    override var size: Int = 0
+        private set
+
+    /**
+     * Number of points dropped from the head over the buffer's lifetime, by
+     * FIFO eviction or [clear]. The point at index `i` has sequence number
+     * `evictedCount + i`.
+     */
+    var evictedCount: Long = 0L
+        private set
+
+    /** Sequence number the next added point will get; grows monotonically. */
+    val version: Long
+        get() = evictedCount + size
+
+    val isFull: Boolean
+        get() = size == capacity
 
     fun add(point: PathPoint) {
-        if (maxPoints <= 0) return
-        if (deque.size >= maxPoints) {
-            deque.removeFirst()
+        add(point.x, point.y, point.tMillis)
+    }
+
+    fun add(x: Float, y: Float, tMillis: Long) {
+        if (capacity == 0) return
+        val slot: Int
+        if (size == capacity) {
+            slot = head
+            head = wrap(head + 1)
+            evictedCount++
+        } else {
+            slot = wrap(head + size)
+            size++
+        }
+        xs[slot] = x
+        ys[slot] = y
+        ts[slot] = tMillis
+    }
+
+    /**
+     * Replaces the contents with the first [count] points of the given
+     * columns whose [keep] flag is set. Modeled as evicting every current
+     * point and appending the survivors, so sequence numbers stay monotonic
+     * and delta consumers resync from the next [PathEvent.Appended].
+     */
+    fun compact(xs: FloatArray, ys: FloatArray, ts: LongArray, keep: BooleanArray, count: Int) {
+        evictedCount += size
+        head = 0
+        size = 0
+        for (i in 0 until count) {
+            if (!keep[i]) continue
+            this.xs[size] = xs[i]
+            this.ys[size] = ys[i]
+            this.ts[size] = ts[i]
+            size++
         }
-        deque.addLast(point)
     }
 
     fun clear() {
-        deque.clear()
+        evictedCount += size
+        head = 0
+        size = 0
+    }
+
+    override fun x(index: Int): Float = xs[wrap(head + index)]
+
+    override fun y(index: Int): Float = ys[wrap(head + index)]
+
+    override fun tMillis(index: Int): Long = ts[wrap(head + index)]
+
+    /** Unwrapped copy of the columns, safe to hand to another thread. */
+    fun copyColumns(): PointColumns {
+        val xs = FloatArray(size)
+        val ys = FloatArray(size)
+        val ts = LongArray(size)
+        val split = minOf(size, capacity - head)
+        this.xs.copyInto(xs, 0, head, head + split)
+        this.ys.copyInto(ys, 0, head, head + split)
+        this.ts.copyInto(ts, 0, head, head + split)
+        if (split < size) {
+            this.xs.copyInto(xs, split, 0, size - split)
+            this.ys.copyInto(ys, split, 0, size - split)
+            this.ts.copyInto(ts, split, 0, size - split)
+        }
+        return PointColumns(xs, ys, ts)
+    }
+
+    fun lastOrNull(): PathPoint? = if (size == 0) null else pointAt(size - 1)
+
+    private fun wrap(i: Int): Int = if (i >= capacity) i - capacity else i
+}
+
+/** Immutable [PointView] over primitive columns. */
+internal class PointColumns(
+    private val xs: FloatArray,
+    private val ys: FloatArray,
+    private val ts: LongArray,
+) : PointView {
+    override val size: Int
+        get() = xs.size
+
+    override fun x(index: Int): Float = xs[index]
+
+    override fun y(index: Int): Float = ys[index]
+
+    override fun tMillis(index: Int): Long = ts[index]
+}
+
+/**
+ * Lock-guarded mirror of a live path that the analysis worker copies on
+ * demand. The main thread appends each accepted point in O(1); the O(n)
+ * column copy is made only for live snapshots the worker actually takes,
+ * so snapshots conflated away unread cost nothing.
+ */
+internal class SharedPointBuffer(capacity: Int) {
+    private val lock = SynchronizedObject()
+    private val points = PointBuffer(capacity)
+    private var owner: String? = null
+
+    /** Empties the mirror for the path [owner]. */
+    fun reset(owner: String?) {
+        synchronized(lock) {
+            points.clear()
+            this.owner = owner
+        }
+    }
+
+    fun add(x: Float, y: Float, tMillis: Long) {
+        synchronized(lock) { points.add(x, y, tMillis) }
     }
 
-    fun lastOrNull(): PathPoint? = deque.lastOrNull()
+    /** Copies [source] wholesale, after it was compacted in place. */
+    fun mirror(source: PointView) {
+        synchronized(lock) {
+            points.clear()
+            for (i in 0 until source.size) points.add(source.x(i), source.y(i), source.tMillis(i))
+        }
+    }
 
-    fun toList(): List<PathPoint> = deque.toList()
+    /** The path's current points, or null once the mirror holds another path. */
+    fun copyFor(owner: String): PointColumns? = synchronized(lock) {
+        if (this.owner == owner) points.copyColumns() else null
+    }
 }
@@ -0,0 +1,405 @@
+package com.dayushmand.pathsense.core
+
+import kotlinx.atomicfu.locks.SynchronizedObject
+import kotlinx.atomicfu.locks.synchronized
+import kotlin.math.PI
+import kotlin.math.cos
+import kotlin.math.max
+import kotlin.math.min
+import kotlin.math.roundToInt
+import kotlin.math.sin
+import kotlin.math.sqrt
+
+/**
+ * $Q point-cloud recognizer: matches the *set* of points drawn, so stroke
+ * direction, order and count do not matter — a clockwise circle matches a
+ * counter-clockwise template and an X drawn as two strokes matches in either
+ * order.
+ *
+ * Strokes arrive one [recognize] call per [PathTracker] session. Strokes that
+ * start within [strokeWindowMs] of the previous stroke's end are merged into
+ * one multistroke candidate; a longer pause starts a new gesture.
+ *
+ * Matching follows $Q: clouds are resampled to [SAMPLE_COUNT] points and
+ * quantized onto a [LUT_SIZE]² grid whose lookup table of nearest points
+ * yields cheap lower bounds, so most alignments of losing templates are never
+ * evaluated, and the remaining greedy matches abandon as soon as they exceed
+ * the best distance so far.
+ */
+class PointCloudRecognizer(
+    private val strokeWindowMs: Long = 1000L,
+    private val threshold: Float = 0.8f,
+    private val maxStrokes: Int = 8,
+) : GestureRecognizer {
+    // Needed for Swift interop — KMM doesn't export default param values to ObjC/Swift
+    constructor() : this(1000L)
+
+    private val lock = SynchronizedObject()
+    private val templates = ArrayList<Template>()
+
+    // Pending multistroke candidate: raw points tagged with their stroke index.
+    private var pendingX = FloatArray(256)
+    private var pendingY = FloatArray(256)
+    private var pendingStroke = IntArray(256)
+    private var pendingCount = 0
+    private var pendingStrokes = 0
+    private var lastStrokeEndMillis = Long.MIN_VALUE
+
+    private val candidate = Cloud()
+    private val scratch = Scratch()
+
+    /** Adds a template drawn as one or more [strokes]. */
+    fun addTemplate(name: String, type: GestureType, strokes: List<List<PathPoint>>) {
+        val cloud = Cloud()
+        var count = 0
+        for (stroke in strokes) count += stroke.size
+        val xs = FloatArray(count)
+        val ys = FloatArray(count)
+        val ids = IntArray(count)
+        var i = 0
+        strokes.forEachIndexed { strokeIndex, stroke ->
+            for (p in stroke) {
+                xs[i] = p.x
+                ys[i] = p.y
+                ids[i] = strokeIndex
+                i++
+            }
+        }
+        cloud.normalize(xs, ys, ids, count)
+        synchronized(lock) {
+            templates.add(Template(name, type, cloud))
+        }
+    }
+
+    /** Forgets strokes collected for the gesture in progress. */
+    fun reset() {
+        synchronized(lock) {
+            pendingCount = 0
+            pendingStrokes = 0
+            lastStrokeEndMillis = Long.MIN_VALUE
+        }
+    }
+
+    override fun recognize(points: List<PathPoint>): GestureMatch? {
+        if (points.isEmpty()) return null
+        synchronized(lock) {
+            appendStroke(points)
+            if (templates.isEmpty() || pendingCount < 2) return null
+            candidate.normalize(pendingX, pendingY, pendingStroke, pendingCount)
+
+            var best: Template? = null
+            var bestDistance = Float.POSITIVE_INFINITY
+            for (template in templates) {
+                val d = cloudMatch(candidate, template.cloud, bestDistance)
+                if (d < bestDistance) {
+                    bestDistance = d
+                    best = template
+                }
+            }
+            if (best == null) return GestureMatch(GestureType.UNKNOWN, 0f, ALGORITHM)
+
+            // Weighted mean squared distance in unit-box coordinates → 0..1.
+            val meanSq = bestDistance / WEIGHT_SUM
+            val score = (1f - 2f * sqrt(meanSq)).coerceIn(0f, 1f)
+            return if (score >= threshold) {
+                GestureMatch(best.type, score, ALGORITHM, best.name)
+            } else {
+                GestureMatch(GestureType.UNKNOWN, score, ALGORITHM)
+            }
+        }
+    }
+
+    private fun appendStroke(points: List<PathPoint>) {
+        val start = points.first().tMillis
+        if (lastStrokeEndMillis != Long.MIN_VALUE && start - lastStrokeEndMillis > strokeWindowMs) {
+            pendingCount = 0
+            pendingStrokes = 0
+        }
+        if (pendingStrokes >= maxStrokes) {
+            dropOldestStroke()
+        }
+        val needed = pendingCount + points.size
+        if (needed > pendingX.size) {
+            val capacity = max(needed, pendingX.size * 2)
+            pendingX = pendingX.copyOf(capacity)
+            pendingY = pendingY.copyOf(capacity)
+            pendingStroke = pendingStroke.copyOf(capacity)
+        }
+        for (p in points) {
+            pendingX[pendingCount] = p.x
+            pendingY[pendingCount] = p.y
+            pendingStroke[pendingCount] = pendingStrokes
+            pendingCount++
+        }
+        pendingStrokes++
+        lastStrokeEndMillis = points.last().tMillis
+    }
+
+    private fun dropOldestStroke() {
+        var firstKept = 0
+        while (firstKept < pendingCount && pendingStroke[firstKept] == 0) firstKept++
+        val kept = pendingCount - firstKept
+        pendingX.copyInto(pendingX, 0, firstKept, pendingCount)
+        pendingY.copyInto(pendingY, 0, firstKept, pendingCount)
+        for (i in 0 until kept) {
+            pendingStroke[i] = pendingStroke[firstKept + i] - 1
+        }
+        pendingCount = kept
+        pendingStrokes--
+    }
+
+    /** $Q CLOUD-MATCH: best alignment distance, or ≥ [minSoFar] if it cannot win. */
+    private fun cloudMatch(points: Cloud, template: Cloud, minSoFar: Float): Float {
+        var best = minSoFar
+        val step = STEP
+        computeLowerBound(points, template, scratch.lb1)
+        computeLowerBound(template, points, scratch.lb2)
+        var i = 0
+        var block = 0
+        while (i < SAMPLE_COUNT) {
+            if (scratch.lb1[block] < best) {
+                best = min(best, cloudDistance(points, template, i, best))
+            }
+            if (scratch.lb2[block] < best) {
+                best = min(best, cloudDistance(template, points, i, best))
+            }
+            i += step
+            block++
+        }
+        return best
+    }
+
+    /** $Q CLOUD-DISTANCE: greedy weighted matching starting at [start], abandoned past [minSoFar]. */
+    private fun cloudDistance(points: Cloud, template: Cloud, start: Int, minSoFar: Float): Float {
+        val unmatched = scratch.unmatched
+        for (j in 0 until SAMPLE_COUNT) unmatched[j] = j
+        var remaining = SAMPLE_COUNT
+        var i = start
+        var weight = SAMPLE_COUNT
+        var sum = 0f
+        do {
+            var index = -1
+            var minDistance = Float.POSITIVE_INFINITY
+            val px = points.xs[i]
+            val py = points.ys[i]
+            for (k in 0 until remaining) {
+                val j = unmatched[k]
+                val dx = px - template.xs[j]
+                val dy = py - template.ys[j]
+                val d = dx * dx + dy * dy
+                if (d < minDistance) {
+                    minDistance = d
+                    index = k
+                }
+            }
+            unmatched[index] = unmatched[--remaining]
+            sum += weight * minDistance
+            if (sum >= minSoFar) return sum
+            weight--
+            i = (i + 1) % SAMPLE_COUNT
+        } while (i != start)
+        return sum
+    }
+
+    /** $Q COMPUTE-LOWER-BOUND via [template]'s nearest-point lookup table. */
+    private fun computeLowerBound(points: Cloud, template: Cloud, out: FloatArray) {
+        val sat = scratch.sat
+        val n = SAMPLE_COUNT
+        out[0] = 0f
+        for (i in 0 until n) {
+            val index = template.lut[points.cells[i]]
+            val dx = points.xs[i] - template.xs[index]
+            val dy = points.ys[i] - template.ys[index]
+            val d = dx * dx + dy * dy
+            sat[i] = if (i == 0) d else sat[i - 1] + d
+            out[0] += (n - i) * d
+        }
+        var i = STEP
+        while (i < n) {
+            out[i / STEP] = out[0] + i * sat[n - 1] - n * sat[i - 1]
+            i += STEP
+        }
+    }
+
+    private class Template(val name: String, val type: GestureType, val cloud: Cloud)
+
+    private class Scratch {
+        val unmatched = IntArray(SAMPLE_COUNT)
+        val sat = FloatArray(SAMPLE_COUNT)
+        val lb1 = FloatArray(SAMPLE_COUNT / STEP + 1)
+        val lb2 = FloatArray(SAMPLE_COUNT / STEP + 1)
+    }
+
+    /** A normalized point cloud plus its LUT; reusable for successive candidates. */
+    private class Cloud {
+        val xs = FloatArray(SAMPLE_COUNT)
+        val ys = FloatArray(SAMPLE_COUNT)
+
+        /** Grid cell (`y * LUT_SIZE + x`) of each point. */
+        val cells = IntArray(SAMPLE_COUNT)
+
+        /** Index of the point nearest to each grid cell. */
+        val lut = IntArray(LUT_SIZE * LUT_SIZE)
+
+        fun normalize(srcX: FloatArray, srcY: FloatArray, strokes: IntArray, count: Int) {
+            resample(srcX, srcY, strokes, count)
+            scaleAndTranslate()
+            computeLut()
+        }
+
+        private fun resample(srcX: FloatArray, srcY: FloatArray, strokes: IntArray, count: Int) {
+            var length = 0f
+            for (i in 1 until count) {
+                if (strokes[i] == strokes[i - 1]) {
+                    length += MathUtils.distance(srcX[i - 1], srcY[i - 1], srcX[i], srcY[i])
+                }
+            }
+            if (count == 0 || length <= 0f) {
+                xs.fill(if (count > 0) srcX[0] else 0f)
+                ys.fill(if (count > 0) srcY[0] else 0f)
+                return
+            }
+            val interval = length / (SAMPLE_COUNT - 1)
+            var n = 0
+            var prevX = srcX[0]
+            var prevY = srcY[0]
+            xs[n] = prevX
+            ys[n] = prevY
+            n++
+            var distanceSoFar = 0f
+            var i = 1
+            while (i < count && n < SAMPLE_COUNT) {
+                if (strokes[i] != strokes[i - 1]) {
+                    // Pen lifted: the gap between strokes is not part of the path.
+                    prevX = srcX[i]
+                    prevY = srcY[i]
+                    i++
+                    continue
+                }
+                val d = MathUtils.distance(prevX, prevY, srcX[i], srcY[i])
+                if (distanceSoFar + d >= interval && d > 0f) {
+                    val t = (interval - distanceSoFar) / d
+                    prevX += t * (srcX[i] - prevX)
+                    prevY += t * (srcY[i] - prevY)
+                    xs[n] = prevX
+                    ys[n] = prevY
+                    n++
+                    distanceSoFar = 0f
+                } else {
+                    distanceSoFar += d
+                    prevX = srcX[i]
+                    prevY = srcY[i]
+                    i++
+                }
+            }
+            while (n < SAMPLE_COUNT) {
+                xs[n] = srcX[count - 1]
+                ys[n] = srcY[count - 1]
+                n++
+            }
+        }
+
+        private fun scaleAndTranslate() {
+            var minX = Float.POSITIVE_INFINITY
+            var minY = Float.POSITIVE_INFINITY
+            var maxX = Float.NEGATIVE_INFINITY
+            var maxY = Float.NEGATIVE_INFINITY
+            var sumX = 0f
+            var sumY = 0f
+            for (i in 0 until SAMPLE_COUNT) {
+                minX = min(minX, xs[i])
+                minY = min(minY, ys[i])
+                maxX = max(maxX, xs[i])
+                maxY = max(maxY, ys[i])
+                sumX += xs[i]
+                sumY += ys[i]
+            }
+            val scale = max(maxX - minX, maxY - minY).let { if (it > 0f) 1f / it else 1f }
+            val cx = sumX / SAMPLE_COUNT
+            val cy = sumY / SAMPLE_COUNT
+            for (i in 0 until SAMPLE_COUNT) {
+                xs[i] = (xs[i] - cx) * scale
+                ys[i] = (ys[i] - cy) * scale
+            }
+        }
+
+        private fun computeLut() {
+            val last = LUT_SIZE - 1
+            for (i in 0 until SAMPLE_COUNT) {
+                val gx = ((xs[i] + 1f) / 2f * last).roundToInt().coerceIn(0, last)
+                val gy = ((ys[i] + 1f) / 2f * last).roundToInt().coerceIn(0, last)
+                cells[i] = gy * LUT_SIZE + gx
+            }
+            for (gy in 0 until LUT_SIZE) {
+                for (gx in 0 until LUT_SIZE) {
+                    var index = 0
+                    var minDistance = Int.MAX_VALUE
+                    for (i in 0 until SAMPLE_COUNT) {
+                        val dx = cells[i] % LUT_SIZE - gx
+                        val dy = cells[i] / LUT_SIZE - gy
+                        val d = dx * dx + dy * dy
+                        if (d < minDistance) {
+                            minDistance = d
+                            index = i
+                        }
+                    }
+                    lut[gy * LUT_SIZE + gx] = index
+                }
+            }
+        }
+    }
+
+    companion object {
+        const val SAMPLE_COUNT = 32
+        const val LUT_SIZE = 64
+        private const val ALGORITHM = "pointcloud"
+
+        /** floor(√n) start positions per alignment sweep, as in $Q. */
+        private const val STEP = 5
+
+        private const val WEIGHT_SUM = SAMPLE_COUNT * (SAMPLE_COUNT + 1) / 2f
+
+        /** Recognizer pre-populated with the built-in shapes as point clouds. */
+        fun withDefaults(strokeWindowMs: Long = 1000L): PointCloudRecognizer =
+            PointCloudRecognizer(strokeWindowMs).apply {
+                addTemplate("line", GestureType.LINE, listOf(listOf(PathPoint(0f, 0f, 0L), PathPoint(100f, 0f, 10L))))
+                val steps = 64
+                addTemplate(
+                    "circle",
+                    GestureType.CIRCLE,
+                    listOf(
+                        List(steps + 1) { i ->
+                            val t = (2 * PI * i / steps).toFloat()
+                            PathPoint(cos(t) * 50f, sin(t) * 50f, i.toLong())
+                        },
+                    ),
+                )
+                addTemplate(
+                    "rectangle",
+                    GestureType.RECTANGLE,
+                    listOf(
+                        listOf(
+                            PathPoint(0f, 0f, 0L),
+                            PathPoint(100f, 0f, 10L),
+                            PathPoint(100f, 60f, 20L),
+                            PathPoint(0f, 60f, 30L),
+                            PathPoint(0f, 0f, 40L),
+                        ),
+                    ),
+                )
+                addTemplate(
+                    "zigzag",
+                    GestureType.ZIGZAG,
+                    listOf(
+                        listOf(
+                            PathPoint(0f, 0f, 0L),
+                            PathPoint(30f, 20f, 10L),
+                            PathPoint(60f, -20f, 20L),
+                            PathPoint(90f, 20f, 30L),
+                            PathPoint(120f, -20f, 40L),
+                        ),
+                    ),
+                )
+            }
+    }
+}
@@ -0,0 +1,59 @@
+package com.dayushmand.pathsense.core
+
+/**
+ * Smoothing stage between raw input and the point buffer, one instance per
+ * session. [filter] returns the point to store; [predict] extrapolates where
+ * the finger will be [aheadMs] after the last filtered point.
+ */
+internal interface PointFilter {
+    fun reset()
+
+    fun filter(p: PathPoint): PathPoint
+
+    fun predict(aheadMs: Int): PathPoint?
+
+    companion object {
+        fun create(config: PathConfig): PointFilter = when (val s = config.smoothing) {
+            SmoothingFilter.None -> MovingAverageFilter(enabled = false)
+            SmoothingFilter.MovingAverage -> MovingAverageFilter(enabled = config.smoothingWindow >= 3)
+            is SmoothingFilter.OneEuro -> OneEuroFilter(s.minCutoffHz, s.beta, s.derivativeCutoffHz)
+            is SmoothingFilter.Kalman -> KalmanFilter(s.processNoise, s.measurementNoise)
+        }
+    }
+}
+
+/**
+ * The original 3-point average of the two previous outputs and the new input;
+ * about one sample of lag. Predicts by extending the last output segment.
+ */
+internal class MovingAverageFilter(private val enabled: Boolean) : PointFilter {
+    private var prev1: PathPoint? = null
+    private var prev2: PathPoint? = null
+
+    override fun reset() {
+        prev1 = null
+        prev2 = null
+    }
+
+    override fun filter(p: PathPoint): PathPoint {
+        val p1 = prev1
+        val p2 = prev2
+        val out = if (!enabled || p1 == null || p2 == null) {
+            p
+        } else {
+            PathPoint((p1.x + p2.x + p.x) / 3f, (p1.y + p2.y + p.y) / 3f, p.tMillis)
+        }
+        prev2 = p1
+        prev1 = out
+        return out
+    }
+
+    override fun predict(aheadMs: Int): PathPoint? {
+        val p1 = prev1 ?: return null
+        val p2 = prev2 ?: return null
+        val dt = (p1.tMillis - p2.tMillis).toFloat()
+        if (dt <= 0f) return null
+        val k = aheadMs / dt
+        return PathPoint(p1.x + (p1.x - p2.x) * k, p1.y + (p1.y - p2.y) * k, p1.tMillis + aheadMs)
+    }
+}
@@ -0,0 +1,40 @@
+package com.dayushmand.pathsense.core
+
+/**
+ * Read-only, indexed access to a sequence of points without boxing them into
+ * [PathPoint]s. Index `0` is the oldest point, `size - 1` the newest.
+ *
+ * Views handed out by [PathTracker] are live: they reflect the buffer as it is
+ * right now, so read them on the thread that feeds the tracker and copy with
+ * [toList] if the points must outlive the current callback.
+ */
+interface PointView {
+    val size: Int
+
+    fun x(index: Int): Float
+
+    fun y(index: Int): Float
+
+    fun tMillis(index: Int): Long
+}
+
+fun PointView.isEmpty(): Boolean = size == 0
+
+fun PointView.pointAt(index: Int): PathPoint = PathPoint(x(index), y(index), tMillis(index))
+
+fun PointView.toList(): List<PathPoint> = List(size) { pointAt(it) }
+
+/** Wraps [this] list as a [PointView] without copying it. */
+fun List<PathPoint>.asPointView(): PointView = ListPointView(this)
+
+/** [PointView] over a list; [points] can be swapped so one wrapper serves many calls. */
+internal class ListPointView(var points: List<PathPoint> = emptyList()) : PointView {
+    override val size: Int
+        get() = points.size
+
+    override fun x(index: Int): Float = points[index].x
+
+    override fun y(index: Int): Float = points[index].y
+
+    override fun tMillis(index: Int): Long = points[index].tMillis
+}
@@ -0,0 +1,4 @@
+package com.dayushmand.pathsense.core
+
+/** Number of CPU cores available to the process. */
+internal expect fun availableProcessors(): Int
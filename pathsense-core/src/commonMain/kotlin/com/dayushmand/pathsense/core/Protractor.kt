@@ -0,0 +1,161 @@
+package com.dayushmand.pathsense.core
+
+import kotlin.math.PI
+import kotlin.math.atan2
+import kotlin.math.cos
+import kotlin.math.min
+import kotlin.math.sin
+import kotlin.math.sqrt
+
+/**
+ * Protractor scoring for unit-length interleaved x/y vectors.
+ *
+ * The best similarity over template rotations has a closed form: with
+ * `a = Σ t·c` and `b = Σ t×c`, rotating the template by `θ` gives
+ * `a·cos θ + b·sin θ`, maximized at `θ = atan2(b, a)`. The angle is clamped to
+ * ±[MAX_ROTATION_RAD] so refinement cannot turn one shape into another.
+ *
+ * Early abandoning works per block of points: by Cauchy–Schwarz the blocks not
+ * yet visited can add at most `‖t_rest‖·‖c_rest‖` to `|(a, b)|`, so a template
+ * whose bound drops below the best score so far is skipped.
+ */
+internal object Protractor {
+    /** Floats per abandoning block (8 points). */
+    const val BLOCK = 16
+
+    val MAX_ROTATION_RAD = (PI / 4).toFloat()
+
+    fun blockCount(size: Int): Int = (size + BLOCK - 1) / BLOCK
+
+    /** Writes `‖vector[block * BLOCK ..]‖` for every block into [out]; the last slot is 0. */
+    fun suffixNorms(vector: FloatArray, out: FloatArray = FloatArray(blockCount(vector.size) + 1)): FloatArray {
+        val blocks = blockCount(vector.size)
+        var acc = 0f
+        out[blocks] = 0f
+        for (block in blocks - 1 downTo 0) {
+            val from = block * BLOCK
+            val to = min(from + BLOCK, vector.size)
+            for (i in from until to) {
+                acc += vector[i] * vector[i]
+            }
+            out[block] = sqrt(acc)
+        }
+        return out
+    }
+
+    /**
+     * Similarity of [template] and [candidate] at their optimal rotation, or
+     * [Float.NEGATIVE_INFINITY] once it provably cannot exceed [abandonAtOrBelow].
+     */
+    fun similarity(
+        template: FloatArray,
+        templateNorms: FloatArray,
+        candidate: FloatArray,
+        candidateNorms: FloatArray,
+        abandonAtOrBelow: Float,
+    ): Float = similarity(template, 0, templateNorms, 0, candidate, candidateNorms, abandonAtOrBelow)
+
+    /**
+     * [similarity] against a template stored in a packed matrix: its vector
+     * starts at [templateOffset] and its suffix norms at [normsOffset].
+     */
+    fun similarity(
+        templates: FloatArray,
+        templateOffset: Int,
+        templateNorms: FloatArray,
+        normsOffset: Int,
+        candidate: FloatArray,
+        candidateNorms: FloatArray,
+        abandonAtOrBelow: Float,
+    ): Float {
+        val n = candidate.size
+        var a = 0f
+        var b = 0f
+        var block = 0
+        var i = 0
+        while (i < n) {
+            val end = min(i + BLOCK, n)
+            while (i < end) {
+                val tx = templates[templateOffset + i]
+                val ty = templates[templateOffset + i + 1]
+                val cx = candidate[i]
+                val cy = candidate[i + 1]
+                a += tx * cx + ty * cy
+                b += tx * cy - ty * cx
+                i += 2
+            }
+            block++
+            if (i < n &&
+                sqrt(a * a + b * b) + templateNorms[normsOffset + block] * candidateNorms[block] <= abandonAtOrBelow
+            ) {
+                return Float.NEGATIVE_INFINITY
+            }
+        }
+        return optimalCosine(a, b)
+    }
+
+    /**
+     * Batched kernel: computes the Protractor terms `a` and `b` of [rowCount]
+     * templates in a row-major [matrix] of width [candidate]`.size` in one
+     * sweep. Rows are taken from [rows] when given, else `0 until rowCount`.
+     *
+     * The inner loop handles four points per step with two independent
+     * accumulator pairs, which the JIT keeps in registers and can vectorize.
+     */
+    fun dotProducts(
+        matrix: FloatArray,
+        rows: IntArray?,
+        rowCount: Int,
+        candidate: FloatArray,
+        outA: FloatArray,
+        outB: FloatArray,
+    ) {
+        val dim = candidate.size
+        for (k in 0 until rowCount) {
+            val base = (if (rows != null) rows[k] else k) * dim
+            var a0 = 0f
+            var a1 = 0f
+            var b0 = 0f
+            var b1 = 0f
+            var i = 0
+            while (i + 8 <= dim) {
+                val tx0 = matrix[base + i]
+                val ty0 = matrix[base + i + 1]
+                val tx1 = matrix[base + i + 2]
+                val ty1 = matrix[base + i + 3]
+                val tx2 = matrix[base + i + 4]
+                val ty2 = matrix[base + i + 5]
+                val tx3 = matrix[base + i + 6]
+                val ty3 = matrix[base + i + 7]
+                val cx0 = candidate[i]
+                val cy0 = candidate[i + 1]
+                val cx1 = candidate[i + 2]
+                val cy1 = candidate[i + 3]
+                val cx2 = candidate[i + 4]
+                val cy2 = candidate[i + 5]
+                val cx3 = candidate[i + 6]
+                val cy3 = candidate[i + 7]
+                a0 += tx0 * cx0 + ty0 * cy0 + tx2 * cx2 + ty2 * cy2
+                a1 += tx1 * cx1 + ty1 * cy1 + tx3 * cx3 + ty3 * cy3
+                b0 += tx0 * cy0 - ty0 * cx0 + tx2 * cy2 - ty2 * cx2
+                b1 += tx1 * cy1 - ty1 * cx1 + tx3 * cy3 - ty3 * cx3
+                i += 8
+            }
+            while (i < dim) {
+                val tx = matrix[base + i]
+                val ty = matrix[base + i + 1]
+                a0 += tx * candidate[i] + ty * candidate[i + 1]
+                b0 += tx * candidate[i + 1] - ty * candidate[i]
+                i += 2
+            }
+            outA[k] = a0 + a1
+            outB[k] = b0 + b1
+        }
+    }
+
+    /** `max a·cos θ + b·sin θ` over the allowed rotation window. */
+    fun optimalCosine(a: Float, b: Float): Float {
+        val angle = atan2(b, a).coerceIn(-MAX_ROTATION_RAD, MAX_ROTATION_RAD)
+        return (a * cos(angle) + b * sin(angle)).coerceIn(-1f, 1f)
+    }
+}
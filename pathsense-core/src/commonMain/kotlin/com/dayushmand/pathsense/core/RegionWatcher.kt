@@ -0,0 +1,120 @@
+package com.dayushmand.pathsense.core
+
+import kotlin.math.floor
+import kotlin.math.max
+import kotlin.math.min
+
+/**
+ * Registered hit regions and whether the path is inside each one.
+ *
+ * With a positive [cellPx], regions are filed in a uniform grid so each new
+ * segment only tests the regions sharing its cells; otherwise every region is
+ * tested. Main thread only.
+ */
+internal class RegionWatcher(private val cellPx: Float) {
+    private class Region(val id: String, val bounds: RectF) {
+        var inside = false
+        var stamp = 0
+    }
+
+    private val regions = ArrayList<Region>()
+    private val cells = HashMap<Long, ArrayList<Region>>()
+    private var stamp = 0
+
+    val isEmpty: Boolean
+        get() = regions.isEmpty()
+
+    /** Adds or replaces the region [id]. */
+    fun add(id: String, bounds: RectF) {
+        remove(id)
+        val region = Region(id, bounds)
+        regions.add(region)
+        if (cellPx > 0f) forEachCell(bounds) { key -> cells.getOrPut(key) { ArrayList() }.add(region) }
+    }
+
+    fun remove(id: String) {
+        val region = regions.firstOrNull { it.id == id } ?: return
+        regions.remove(region)
+        if (cellPx > 0f) {
+            forEachCell(region.bounds) { key ->
+                val list = cells[key] ?: return@forEachCell
+                list.remove(region)
+                if (list.isEmpty()) cells.remove(key)
+            }
+        }
+    }
+
+    /**
+     * Updates inside/outside state for the segment a→b (a single point when
+     * a == b) and appends each enter or exit to [out]. A segment passing
+     * through a region reports both.
+     */
+    fun onSegment(sessionId: String, ax: Float, ay: Float, bx: Float, by: Float, out: MutableList<PathEvent>) {
+        if (cellPx <= 0f) {
+            for (i in regions.indices) step(regions[i], sessionId, ax, ay, bx, by, out)
+            return
+        }
+        val pass = ++stamp
+        val left = cellOf(min(ax, bx))
+        val top = cellOf(min(ay, by))
+        val right = cellOf(max(ax, bx))
+        val bottom = cellOf(max(ay, by))
+        for (cx in left..right) {
+            for (cy in top..bottom) {
+                val list = cells[keyOf(cx, cy)] ?: continue
+                for (i in list.indices) {
+                    val region = list[i]
+                    if (region.stamp == pass) continue
+                    region.stamp = pass
+                    step(region, sessionId, ax, ay, bx, by, out)
+                }
+            }
+        }
+    }
+
+    /** Exits every region the path is inside, e.g. when it lifts. */
+    fun exitAll(sessionId: String, out: MutableList<PathEvent>) {
+        for (i in regions.indices) {
+            val region = regions[i]
+            if (region.inside) {
+                region.inside = false
+                out.add(PathEvent.RegionExited(sessionId, region.id))
+            }
+        }
+    }
+
+    /** Forgets inside state without reporting exits. */
+    fun reset() {
+        for (region in regions) region.inside = false
+    }
+
+    private fun step(
+        region: Region,
+        sessionId: String,
+        ax: Float,
+        ay: Float,
+        bx: Float,
+        by: Float,
+        out: MutableList<PathEvent>,
+    ) {
+        val b = region.bounds
+        val wasInside = region.inside
+        val touched = wasInside ||
+            MathUtils.segmentIntersectsRect(ax, ay, bx, by, b.left, b.top, b.right, b.bottom)
+        if (!touched) return
+        if (!wasInside) out.add(PathEvent.RegionEntered(sessionId, region.id))
+        val nowInside = bx >= b.left && bx <= b.right && by >= b.top && by <= b.bottom
+        if (!nowInside) out.add(PathEvent.RegionExited(sessionId, region.id))
+        region.inside = nowInside
+    }
+
+    private inline fun forEachCell(bounds: RectF, action: (Long) -> Unit) {
+        for (cx in cellOf(bounds.left)..cellOf(bounds.right)) {
+            for (cy in cellOf(bounds.top)..cellOf(bounds.bottom)) action(keyOf(cx, cy))
+        }
+    }
+
+    private fun cellOf(v: Float): Int = floor(v / cellPx).toInt()
+
+    private fun keyOf(cx: Int, cy: Int): Long = (cx.toLong() shl 32) or (cy.toLong() and 0xFFFFFFFFL)
+}
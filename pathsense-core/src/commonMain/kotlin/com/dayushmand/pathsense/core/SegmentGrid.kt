@@ -0,0 +1,235 @@
+package com.dayushmand.pathsense.core
+
+import kotlin.math.floor
+import kotlin.math.max
+import kotlin.math.min
+
+/**
+ * Uniform grid of segment buckets kept in step with a [PointBuffer], for
+ * hit-testing the live path without scanning it.
+ *
+ * Entry `s` is the segment ending at the point with sequence number `s` (a
+ * single point for a path's first point). It is filed under every cell its
+ * bounding box touches. Entries are added and evicted in sequence order, so
+ * every bucket is a FIFO and eviction pops bucket heads. Main thread only.
+ */
+internal class SegmentGrid(private val cellPx: Float, private val buffer: PointBuffer) {
+    private val buckets = HashMap<Long, Bucket>()
+    private val spare = ArrayList<Bucket>()
+
+    // Cell range each live entry was filed under, by sequence number mod capacity.
+    private val capacity = max(1, buffer.capacity)
+    private val cellLeft = IntArray(capacity)
+    private val cellTop = IntArray(capacity)
+    private val cellRight = IntArray(capacity)
+    private val cellBottom = IntArray(capacity)
+
+    fun clear() {
+        for (bucket in buckets.values) {
+            bucket.clear()
+            spare.add(bucket)
+        }
+        buckets.clear()
+    }
+
+    /** Files the buffer's newest point; call after [PointBuffer.add]. */
+    fun onAppended() {
+        val last = buffer.size - 1
+        if (last < 0) return
+        file(last)
+    }
+
+    /** Unfiles the buffer's oldest point; call before an add that evicts it. */
+    fun onEvicting() {
+        if (buffer.size == 0) return
+        val seq = buffer.evictedCount
+        val slot = slotOf(seq)
+        for (cx in cellLeft[slot]..cellRight[slot]) {
+            for (cy in cellTop[slot]..cellBottom[slot]) {
+                val key = keyOf(cx, cy)
+                val bucket = buckets[key] ?: continue
+                bucket.popHead(seq)
+                if (bucket.isEmpty) {
+                    buckets.remove(key)
+                    spare.add(bucket)
+                }
+            }
+        }
+    }
+
+    /** Refiles every point, after the buffer was rewritten wholesale. */
+    fun rebuild() {
+        clear()
+        for (i in 0 until buffer.size) file(i)
+    }
+
+    /** Whether any live segment touches [bounds]. */
+    fun crosses(bounds: RectF): Boolean {
+        val left = cellOf(bounds.left)
+        val top = cellOf(bounds.top)
+        val right = cellOf(bounds.right)
+        val bottom = cellOf(bounds.bottom)
+        // A region wider than the path is cheaper to test segment by segment.
+        if ((right - left + 1).toLong() * (bottom - top + 1) > buffer.size) return scanCrosses(buffer, bounds)
+        val evicted = buffer.evictedCount
+        for (cx in left..right) {
+            for (cy in top..bottom) {
+                val bucket = buckets[keyOf(cx, cy)] ?: continue
+                for (k in 0 until bucket.size) {
+                    val i = (bucket[k] - evicted).toInt()
+                    val from = max(0, i - 1)
+                    if (MathUtils.segmentIntersectsRect(
+                            buffer.x(from), buffer.y(from), buffer.x(i), buffer.y(i),
+                            bounds.left, bounds.top, bounds.right, bounds.bottom,
+                        )
+                    ) {
+                        return true
+                    }
+                }
+            }
+        }
+        return false
+    }
+
+    /** Index of the live point nearest ([x], [y]), or -1 if the buffer is empty. */
+    fun nearestIndex(x: Float, y: Float): Int {
+        if (buffer.size == 0) return -1
+        val cx = cellOf(x)
+        val cy = cellOf(y)
+        val evicted = buffer.evictedCount
+        var best = -1
+        var bestDistSq = Float.POSITIVE_INFINITY
+        var visited = 0
+        var ring = 0
+        while (true) {
+            // Every cell in ring r + 1 is at least r cells away from the query.
+            if (best >= 0) {
+                val reach = ring - 1
+                if (reach > 0 && bestDistSq <= (reach * cellPx) * (reach * cellPx)) return best
+            }
+            if (visited > buffer.size) return scanNearest(buffer, x, y)
+            // Walk only the ring's perimeter: full edge columns, else top and bottom cells.
+            for (gx in cx - ring..cx + ring) {
+                val edge = gx == cx - ring || gx == cx + ring
+                val step = if (edge || ring == 0) 1 else 2 * ring
+                var gy = cy - ring
+                while (gy <= cy + ring) {
+                    visited++
+                    val bucket = buckets[keyOf(gx, gy)]
+                    gy += step
+                    if (bucket == null) continue
+                    for (k in 0 until bucket.size) {
+                        val i = (bucket[k] - evicted).toInt()
+                        val dx = buffer.x(i) - x
+                        val dy = buffer.y(i) - y
+                        val distSq = dx * dx + dy * dy
+                        if (distSq < bestDistSq) {
+                            bestDistSq = distSq
+                            best = i
+                        }
+                    }
+                }
+            }
+            ring++
+        }
+    }
+
+    private fun file(i: Int) {
+        val from = max(0, i - 1)
+        val ax = buffer.x(from)
+        val ay = buffer.y(from)
+        val bx = buffer.x(i)
+        val by = buffer.y(i)
+        val seq = buffer.evictedCount + i
+        val slot = slotOf(seq)
+        val left = cellOf(min(ax, bx))
+        val top = cellOf(min(ay, by))
+        val right = cellOf(max(ax, bx))
+        val bottom = cellOf(max(ay, by))
+        cellLeft[slot] = left
+        cellTop[slot] = top
+        cellRight[slot] = right
+        cellBottom[slot] = bottom
+        for (cx in left..right) {
+            for (cy in top..bottom) {
+                val key = keyOf(cx, cy)
+                val bucket = buckets[key]
+                    ?: (if (spare.isEmpty()) Bucket() else spare.removeAt(spare.size - 1)).also { buckets[key] = it }
+                bucket.push(seq)
+            }
+        }
+    }
+
+    private fun slotOf(seq: Long): Int = (seq % capacity).toInt()
+
+    private fun cellOf(v: Float): Int = floor(v / cellPx).toInt()
+
+    /** Growable FIFO of entry sequence numbers. */
+    private class Bucket {
+        private var seqs = LongArray(4)
+        private var head = 0
+        var size = 0
+            private set
+
+        val isEmpty: Boolean
+            get() = size == 0
+
+        operator fun get(k: Int): Long = seqs[(head + k) % seqs.size]
+
+        fun push(seq: Long) {
+            if (size == seqs.size) {
+                seqs = LongArray(size * 2) { get(it % size) }
+                head = 0
+            }
+            seqs[(head + size) % seqs.size] = seq
+            size++
+        }
+
+        fun popHead(seq: Long) {
+            if (size > 0 && seqs[head] == seq) {
+                head = (head + 1) % seqs.size
+                size--
+            }
+        }
+
+        fun clear() {
+            head = 0
+            size = 0
+        }
+    }
+
+    companion object {
+        private fun keyOf(cx: Int, cy: Int): Long = (cx.toLong() shl 32) or (cy.toLong() and 0xFFFFFFFFL)
+
+        /** Linear [crosses] over any point view. */
+        fun scanCrosses(points: PointView, bounds: RectF): Boolean {
+            for (i in 0 until points.size) {
+                val from = max(0, i - 1)
+                if (MathUtils.segmentIntersectsRect(
+                        points.x(from), points.y(from), points.x(i), points.y(i),
+                        bounds.left, bounds.top, bounds.right, bounds.bottom,
+                    )
+                ) {
+                    return true
+                }
+            }
+            return false
+        }
+
+        /** Linear [nearestIndex] over any point view. */
+        fun scanNearest(points: PointView, x: Float, y: Float): Int {
+            var best = -1
+            var bestDistSq = Float.POSITIVE_INFINITY
+            for (i in 0 until points.size) {
+                val dx = points.x(i) - x
+                val dy = points.y(i) - y
+                val distSq = dx * dx + dy * dy
+                if (distSq < bestDistSq) {
+                    bestDistSq = distSq
+                    best = i
+                }
+            }
+            return best
+        }
+    }
+}
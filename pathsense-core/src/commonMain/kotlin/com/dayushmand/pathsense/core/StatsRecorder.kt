@@ -0,0 +1,119 @@
+package com.dayushmand.pathsense.core
+
+import kotlinx.atomicfu.AtomicLongArray
+import kotlinx.atomicfu.atomic
+import kotlinx.atomicfu.update
+import kotlin.time.TimeSource
+
+/**
+ * Lock-free instrumentation behind [PathStats]. Recording is a handful of
+ * atomic increments, safe from the main thread and any number of analysis
+ * workers at once. Only allocated when [PathConfig.collectStats] is on.
+ */
+internal class StatsRecorder {
+    private val origin = TimeSource.Monotonic.markNow()
+
+    val onMove = LatencyHistogram()
+    val listener = LatencyHistogram()
+    val metricsDelay = LatencyHistogram()
+    private val recognition = atomic(emptyMap<GestureRecognizer, LatencyHistogram>())
+    private val conflated = atomic(0L)
+    private val rejectedByRate = atomic(0L)
+    private val rejectedByDistance = atomic(0L)
+    private val recognizerFailures = atomic(0L)
+
+    /** Monotonic nanoseconds since this recorder was created. */
+    fun nanosNow(): Long = origin.elapsedNow().inWholeNanoseconds
+
+    fun recordRecognition(r: GestureRecognizer, nanos: Long) {
+        var histogram = recognition.value[r]
+        if (histogram == null) {
+            recognition.update { if (r in it) it else it + (r to LatencyHistogram()) }
+            histogram = recognition.value.getValue(r)
+        }
+        histogram.record(nanos)
+    }
+
+    fun onConflated() {
+        conflated.incrementAndGet()
+    }
+
+    fun onRejectedByRate() {
+        rejectedByRate.incrementAndGet()
+    }
+
+    fun onRejectedByDistance() {
+        rejectedByDistance.incrementAndGet()
+    }
+
+    fun onRecognizerFailed() {
+        recognizerFailures.incrementAndGet()
+    }
+
+    fun snapshot(): PathStats {
+        val byName = LinkedHashMap<String, LatencySnapshot>()
+        for ((r, histogram) in recognition.value) {
+            val base = r::class.simpleName ?: "recognizer"
+            var name = base
+            var n = 2
+            while (name in byName) name = "$base#${n++}"
+            byName[name] = histogram.snapshot()
+        }
+        return PathStats(
+            onMove = onMove.snapshot(),
+            listener = listener.snapshot(),
+            metricsDelay = metricsDelay.snapshot(),
+            recognition = byName,
+            conflatedSnapshots = conflated.value,
+            rejectedByRate = rejectedByRate.value,
+            rejectedByDistance = rejectedByDistance.value,
+            recognizerFailures = recognizerFailures.value,
+        )
+    }
+
+    fun reset() {
+        onMove.reset()
+        listener.reset()
+        metricsDelay.reset()
+        for (histogram in recognition.value.values) histogram.reset()
+        conflated.value = 0L
+        rejectedByRate.value = 0L
+        rejectedByDistance.value = 0L
+        recognizerFailures.value = 0L
+    }
+}
+
+/** Lock-free log₂ histogram of nanosecond durations; see [LatencySnapshot]. */
+internal class LatencyHistogram {
+    private val buckets = AtomicLongArray(BUCKETS)
+    private val count = atomic(0L)
+    private val total = atomic(0L)
+    private val max = atomic(0L)
+
+    fun record(nanos: Long) {
+        val n = nanos.coerceAtLeast(0L)
+        val bucket = (Long.SIZE_BITS - n.countLeadingZeroBits()).coerceAtMost(BUCKETS - 1)
+        buckets[bucket].incrementAndGet()
+        count.incrementAndGet()
+        total.addAndGet(n)
+        while (true) {
+            val current = max.value
+            if (n <= current || max.compareAndSet(current, n)) break
+        }
+    }
+
+    fun snapshot(): LatencySnapshot =
+        LatencySnapshot(count.value, total.value, max.value, LongArray(BUCKETS) { buckets[it].value })
+
+    fun reset() {
+        for (i in 0 until BUCKETS) buckets[i].value = 0L
+        count.value = 0L
+        total.value = 0L
+        max.value = 0L
+    }
+
+    private companion object {
+        /** Up to 2^39 ns (~9 min) before samples pile into the last bucket. */
+        const val BUCKETS = 40
+    }
+}
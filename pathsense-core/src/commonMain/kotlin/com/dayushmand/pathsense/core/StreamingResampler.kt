@@ -0,0 +1,87 @@
+package com.dayushmand.pathsense.core
+
+import kotlin.math.min
+
+/**
+ * Resamples a stroke to points [spacing] apart as it is drawn, so a
+ * recognition candidate is ready mid-stroke without re-walking the path.
+ *
+ * Unlike the point ring it keeps the whole stroke, up to [maxSamples];
+ * later points are ignored once full.
+ */
+internal class StreamingResampler(
+    private val spacing: Float,
+    private val maxSamples: Int,
+) : PointView {
+
+    private var xs = FloatArray(min(INITIAL_CAPACITY, maxSamples))
+    private var ys = FloatArray(xs.size)
+    private var ts = LongArray(xs.size)
+
+    private var lastX = 0f
+    private var lastY = 0f
+    private var lastT = 0L
+    private var carried = 0f
+
+    override var size: Int = 0
+        private set
+
+    val isFull: Boolean
+        get() = size == maxSamples
+
+    override fun x(index: Int): Float = xs[index]
+
+    override fun y(index: Int): Float = ys[index]
+
+    override fun tMillis(index: Int): Long = ts[index]
+
+    fun reset() {
+        size = 0
+        carried = 0f
+    }
+
+    /** Feeds the next raw point; returns true if it produced new samples. */
+    fun add(x: Float, y: Float, t: Long): Boolean {
+        if (isFull) return false
+        if (size == 0) {
+            emit(x, y, t)
+            lastX = x
+            lastY = y
+            lastT = t
+            return true
+        }
+        val before = size
+        var d = MathUtils.distance(lastX, lastY, x, y)
+        while (carried + d >= spacing && d > 0f && !isFull) {
+            val f = (spacing - carried) / d
+            lastX += f * (x - lastX)
+            lastY += f * (y - lastY)
+            lastT += (f * (t - lastT)).toLong()
+            emit(lastX, lastY, lastT)
+            carried = 0f
+            d = MathUtils.distance(lastX, lastY, x, y)
+        }
+        carried += d
+        lastX = x
+        lastY = y
+        lastT = t
+        return size > before
+    }
+
+    private fun emit(x: Float, y: Float, t: Long) {
+        if (size == xs.size) {
+            val capacity = min(xs.size * 2, maxSamples)
+            xs = xs.copyOf(capacity)
+            ys = ys.copyOf(capacity)
+            ts = ts.copyOf(capacity)
+        }
+        xs[size] = x
+        ys[size] = y
+        ts[size] = t
+        size++
+    }
+
+    private companion object {
+        const val INITIAL_CAPACITY = 64
+    }
+}
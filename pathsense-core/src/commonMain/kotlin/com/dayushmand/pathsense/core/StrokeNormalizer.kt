@@ -0,0 +1,210 @@
+package com.dayushmand.pathsense.core
+
+import kotlin.math.PI
+import kotlin.math.abs
+import kotlin.math.atan2
+import kotlin.math.cos
+import kotlin.math.max
+import kotlin.math.min
+import kotlin.math.sin
+import kotlin.math.sqrt
+
+/**
+ * Allocation-free $1 normalization: resample → rotate to indicative angle →
+ * scale to unit square → translate centroid to origin → unit vector.
+ *
+ * All stages write into arrays owned by this instance, and rotation, scaling
+ * and translation are fused into two passes around a single centroid. An
+ * instance is scratch space: reuse it across strokes, but never share it
+ * between threads.
+ */
+internal class StrokeNormalizer(val sampleCount: Int = SAMPLE_COUNT) {
+    /** Normalized x coordinates of the last stroke (centroid at origin). */
+    val xs = FloatArray(sampleCount)
+
+    /** Normalized y coordinates of the last stroke (centroid at origin). */
+    val ys = FloatArray(sampleCount)
+
+    /** Interleaved x/y of the last stroke, scaled to unit length. */
+    val vector = FloatArray(sampleCount * 2)
+
+    private var closedness = 0f
+    private var aspect = 1f
+
+    /**
+     * Normalizes [points] and returns [vector]. The returned array is
+     * overwritten by the next call; copy it to keep it.
+     *
+     * When [features] is given, it receives the stroke's shape invariants
+     * (see [FEATURE_ASPECT], [FEATURE_CLOSEDNESS], [FEATURE_TURNING]).
+     */
+    fun normalize(points: PointView, features: FloatArray? = null): FloatArray {
+        resample(points)
+        if (features != null) {
+            features[FEATURE_TURNING] = totalTurning()
+        }
+        rotateScaleTranslate()
+        vectorize()
+        if (features != null) {
+            features[FEATURE_ASPECT] = aspect
+            features[FEATURE_CLOSEDNESS] = closedness
+        }
+        return vector
+    }
+
+    private fun resample(points: PointView) {
+        val n = sampleCount
+        closedness = 0f
+        if (points.isEmpty()) {
+            xs.fill(0f)
+            ys.fill(0f)
+            return
+        }
+        val lastX = points.x(points.size - 1)
+        val lastY = points.y(points.size - 1)
+        val pathLength = Resampler.pathLength(points)
+        if (pathLength > 0f) {
+            closedness = MathUtils.distance(points.x(0), points.y(0), lastX, lastY) / pathLength
+        }
+        if (points.size == 1 || pathLength <= 0f) {
+            xs.fill(points.x(0))
+            ys.fill(points.y(0))
+            return
+        }
+
+        val interval = pathLength / (n - 1)
+        var count = 0
+        var prevX = points.x(0)
+        var prevY = points.y(0)
+        xs[count] = prevX
+        ys[count] = prevY
+        count++
+
+        var distanceSoFar = 0f
+        var i = 1
+        while (i < points.size && count < n) {
+            val currX = points.x(i)
+            val currY = points.y(i)
+            val d = MathUtils.distance(prevX, prevY, currX, currY)
+            if (Resampler.isNearlyZero(d)) {
+                prevX = currX
+                prevY = currY
+                i++
+                continue
+            }
+            if (distanceSoFar + d >= interval) {
+                val t = (interval - distanceSoFar) / d
+                prevX += t * (currX - prevX)
+                prevY += t * (currY - prevY)
+                xs[count] = prevX
+                ys[count] = prevY
+                count++
+                distanceSoFar = 0f
+            } else {
+                distanceSoFar += d
+                prevX = currX
+                prevY = currY
+                i++
+            }
+        }
+
+        while (count < n) {
+            xs[count] = lastX
+            ys[count] = lastY
+            count++
+        }
+    }
+
+    private fun rotateScaleTranslate() {
+        val n = sampleCount
+        var sumX = 0f
+        var sumY = 0f
+        for (i in 0 until n) {
+            sumX += xs[i]
+            sumY += ys[i]
+        }
+        val cx = sumX / n
+        val cy = sumY / n
+
+        // Rotating about the centroid leaves it in place, so one centroid
+        // serves rotation, scaling and translation alike.
+        val angle = atan2((cy - ys[0]).toDouble(), (cx - xs[0]).toDouble())
+        val cos = cos(-angle).toFloat()
+        val sin = sin(-angle).toFloat()
+        var minX = Float.POSITIVE_INFINITY
+        var minY = Float.POSITIVE_INFINITY
+        var maxX = Float.NEGATIVE_INFINITY
+        var maxY = Float.NEGATIVE_INFINITY
+        for (i in 0 until n) {
+            val dx = xs[i] - cx
+            val dy = ys[i] - cy
+            val rx = dx * cos - dy * sin
+            val ry = dx * sin + dy * cos
+            xs[i] = rx
+            ys[i] = ry
+            if (rx < minX) minX = rx
+            if (rx > maxX) maxX = rx
+            if (ry < minY) minY = ry
+            if (ry > maxY) maxY = ry
+        }
+
+        val width = maxX - minX
+        val height = maxY - minY
+        aspect = if (max(width, height) > 0f) min(width, height) / max(width, height) else 1f
+
+        val scaleX = 1f / max(1f, width)
+        val scaleY = 1f / max(1f, height)
+        for (i in 0 until n) {
+            xs[i] *= scaleX
+            ys[i] *= scaleY
+        }
+    }
+
+    /** Sum of absolute turning angles along the resampled stroke, in radians. */
+    private fun totalTurning(): Float {
+        var total = 0.0
+        var prevAngle = Double.NaN
+        for (i in 1 until sampleCount) {
+            val dx = xs[i] - xs[i - 1]
+            val dy = ys[i] - ys[i - 1]
+            if (Resampler.isNearlyZero(dx) && Resampler.isNearlyZero(dy)) continue
+            val angle = atan2(dy.toDouble(), dx.toDouble())
+            if (!prevAngle.isNaN()) {
+                var turn = angle - prevAngle
+                if (turn > PI) turn -= 2 * PI
+                if (turn < -PI) turn += 2 * PI
+                total += abs(turn)
+            }
+            prevAngle = angle
+        }
+        return total.toFloat()
+    }
+
+    private fun vectorize() {
+        var sum = 0f
+        var j = 0
+        for (i in 0 until sampleCount) {
+            val x = xs[i]
+            val y = ys[i]
+            vector[j++] = x
+            vector[j++] = y
+            sum += x * x + y * y
+        }
+        val magnitude = sqrt(sum)
+        if (magnitude > 0f) {
+            val inv = 1f / magnitude
+            for (k in vector.indices) {
+                vector[k] *= inv
+            }
+        }
+    }
+
+    companion object {
+        const val SAMPLE_COUNT = 64
+
+        const val FEATURE_ASPECT = 0
+        const val FEATURE_CLOSEDNESS = 1
+        const val FEATURE_TURNING = 2
+        const val FEATURE_COUNT = 3
+    }
+}
@@ -0,0 +1,395 @@
+package com.dayushmand.pathsense.core
+
+import kotlinx.atomicfu.locks.SynchronizedObject
+import kotlinx.atomicfu.locks.synchronized
+import kotlin.math.PI
+import kotlin.math.acos
+import kotlin.math.min
+
+/**
+ * Runtime-mutable set of $1 templates used by [PathTracker]'s built-in
+ * recognizer (see [PathTracker.templates]).
+ *
+ * Templates are bucketed by three cheap, rotation- and scale-invariant shape
+ * features: aspect ratio of the rotated bounding box, closedness (start–end
+ * gap over path length) and total turning angle. Once the library outgrows a
+ * plain scan, a query scores only the templates in its own and neighbouring
+ * buckets, so latency stays flat as templates are added. Template vectors
+ * live in one contiguous row-major matrix so scoring sweeps memory linearly.
+ * Safe to use from any thread.
+ */
+class TemplateLibrary {
+    private val lock = SynchronizedObject()
+    private val normalizer = StrokeNormalizer()
+    private val features = FloatArray(StrokeNormalizer.FEATURE_COUNT)
+    private val queryNorms = FloatArray(NORMS)
+    private var nextId = 1
+
+    // Templates packed row-major: row r's vector is matrix[r * DIM, (r + 1) * DIM)
+    // and its Protractor suffix norms are suffixNorms[r * NORMS, (r + 1) * NORMS).
+    // Removal moves the last row into the hole, so rows stay dense.
+    private var matrix = FloatArray(INITIAL_ROWS * DIM)
+    private var suffixNorms = FloatArray(INITIAL_ROWS * NORMS)
+    private var rowIds = IntArray(INITIAL_ROWS)
+    private var rowBuckets = IntArray(INITIAL_ROWS)
+    private var rowNames = arrayOfNulls<String>(INITIAL_ROWS)
+    private var rowTypes = arrayOfNulls<GestureType>(INITIAL_ROWS)
+    private var rows = 0
+    private val rowOfId = HashMap<Int, Int>()
+    private val buckets = HashMap<Int, IntList>()
+
+    // Query scratch for the batched kernel, grown with the library.
+    private val candidates = IntList()
+    private var dotA = FloatArray(INITIAL_ROWS)
+    private var dotB = FloatArray(INITIAL_ROWS)
+
+    val size: Int
+        get() = synchronized(lock) { rows }
+
+    /**
+     * Adds a template drawn as [points] and returns its id for [remove].
+     * [name] is reported as [GestureMatch.templateName] when it matches.
+     */
+    fun add(name: String, type: GestureType, points: List<PathPoint>): Int {
+        synchronized(lock) {
+            val vector = normalizer.normalize(points.asPointView(), features)
+            if (rows == rowIds.size) grow()
+            val row = rows++
+            vector.copyInto(matrix, row * DIM)
+            Protractor.suffixNorms(vector, queryNorms).copyInto(suffixNorms, row * NORMS)
+            val id = nextId++
+            val bucket = bucketOf(features)
+            rowIds[row] = id
+            rowBuckets[row] = bucket
+            rowNames[row] = name
+            rowTypes[row] = type
+            rowOfId[id] = row
+            buckets.getOrPut(bucket) { IntList() }.add(row)
+            return id
+        }
+    }
+
+    fun remove(id: Int): Boolean {
+        synchronized(lock) {
+            val row = rowOfId.remove(id) ?: return false
+            val bucket = buckets[rowBuckets[row]]
+            if (bucket != null) {
+                bucket.removeValue(row)
+                if (bucket.size == 0) buckets.remove(rowBuckets[row])
+            }
+            val last = --rows
+            if (row != last) {
+                matrix.copyInto(matrix, row * DIM, last * DIM, (last + 1) * DIM)
+                suffixNorms.copyInto(suffixNorms, row * NORMS, last * NORMS, (last + 1) * NORMS)
+                rowIds[row] = rowIds[last]
+                rowBuckets[row] = rowBuckets[last]
+                rowNames[row] = rowNames[last]
+                rowTypes[row] = rowTypes[last]
+                rowOfId[rowIds[row]] = row
+                buckets[rowBuckets[row]]?.replaceValue(last, row)
+            }
+            rowNames[last] = null
+            rowTypes[last] = null
+            return true
+        }
+    }
+
+    fun clear() {
+        synchronized(lock) {
+            rows = 0
+            rowOfId.clear()
+            buckets.clear()
+            rowNames.fill(null)
+            rowTypes.fill(null)
+        }
+    }
+
+    /**
+     * Independent copy with its own lock and scratch, so parallel workers can
+     * each query one without contending (see [BatchAnalyzer]).
+     */
+    internal fun copy(): TemplateLibrary {
+        synchronized(lock) {
+            val copy = TemplateLibrary()
+            copy.matrix = matrix.copyOf()
+            copy.suffixNorms = suffixNorms.copyOf()
+            copy.rowIds = rowIds.copyOf()
+            copy.rowBuckets = rowBuckets.copyOf()
+            copy.rowNames = rowNames.copyOf()
+            copy.rowTypes = rowTypes.copyOf()
+            copy.rows = rows
+            copy.nextId = nextId
+            copy.rowOfId.putAll(rowOfId)
+            for ((bucket, list) in buckets) {
+                copy.buckets[bucket] = IntList().apply { addAll(list) }
+            }
+            copy.dotA = FloatArray(dotA.size)
+            copy.dotB = FloatArray(dotB.size)
+            return copy
+        }
+    }
+
+    /**
+     * Scores [points] against the library and returns the [k] best templates,
+     * best first, as [GestureMatch]es carrying each template's score and name.
+     *
+     * All candidate templates are scored in one batched sweep over the packed
+     * matrix, so this is the call to use when more than the single best match
+     * is needed.
+     */
+    fun rank(points: List<PathPoint>, k: Int): List<GestureMatch> {
+        synchronized(lock) {
+            if (rows == 0 || k <= 0 || points.size < 2) return emptyList()
+            val vector = normalizer.normalize(points.asPointView(), features)
+
+            val rowList: IntArray?
+            val count: Int
+            if (collectCandidates(features)) {
+                rowList = candidates.items
+                count = candidates.size
+            } else {
+                rowList = null
+                count = rows
+            }
+            Protractor.dotProducts(matrix, rowList, count, vector, dotA, dotB)
+
+            // Partial selection sort: k is small next to the candidate count.
+            val top = min(k, count)
+            val bestIndex = IntArray(top)
+            val bestSimilarity = FloatArray(top) { Float.NEGATIVE_INFINITY }
+            for (i in 0 until count) {
+                val similarity = Protractor.optimalCosine(dotA[i], dotB[i])
+                if (similarity <= bestSimilarity[top - 1]) continue
+                var slot = top - 1
+                while (slot > 0 && bestSimilarity[slot - 1] < similarity) {
+                    bestSimilarity[slot] = bestSimilarity[slot - 1]
+                    bestIndex[slot] = bestIndex[slot - 1]
+                    slot--
+                }
+                bestSimilarity[slot] = similarity
+                bestIndex[slot] = i
+            }
+            return List(top) { n ->
+                val row = if (rowList != null) rowList[bestIndex[n]] else bestIndex[n]
+                GestureMatch(rowTypes[row]!!, similarityToScore(bestSimilarity[n]), "dollar1", rowNames[row])
+            }
+        }
+    }
+
+    /**
+     * Finds the template most similar to a normalized candidate and writes it
+     * into [hit]. Returns `false` when the library is empty.
+     *
+     * Unlike [rank], this scans template by template so that Protractor's
+     * early abandoning can skip most of each losing row.
+     */
+    internal fun bestMatch(
+        vector: FloatArray,
+        norms: FloatArray,
+        features: FloatArray,
+        hit: TemplateHit,
+    ): Boolean {
+        synchronized(lock) {
+            hit.reset()
+            if (rows == 0) return false
+            var best = -1
+            if (collectCandidates(features)) {
+                for (i in 0 until candidates.size) {
+                    val row = candidates.items[i]
+                    if (score(row, vector, norms, hit)) best = row
+                }
+            } else {
+                for (row in 0 until rows) {
+                    if (score(row, vector, norms, hit)) best = row
+                }
+            }
+            if (best >= 0) {
+                hit.name = rowNames[best]!!
+                hit.type = rowTypes[best]!!
+            }
+            return true
+        }
+    }
+
+    private fun score(row: Int, vector: FloatArray, norms: FloatArray, hit: TemplateHit): Boolean {
+        val similarity = Protractor.similarity(
+            matrix,
+            row * DIM,
+            suffixNorms,
+            row * NORMS,
+            vector,
+            norms,
+            hit.similarity,
+        )
+        if (similarity > hit.similarity) {
+            hit.similarity = similarity
+            return true
+        }
+        return false
+    }
+
+    /**
+     * Fills [candidates] with the rows in the query's own and neighbouring
+     * feature buckets. Returns `false` when the library is small enough to
+     * scan in full, or the prefilter found too few rows to trust.
+     */
+    private fun collectCandidates(features: FloatArray): Boolean {
+        if (rows <= LINEAR_SCAN_LIMIT) return false
+        candidates.clear()
+        val a = bin(features[StrokeNormalizer.FEATURE_ASPECT], ASPECT_BINS)
+        val c = bin(features[StrokeNormalizer.FEATURE_CLOSEDNESS], CLOSEDNESS_BINS)
+        val t = bin(features[StrokeNormalizer.FEATURE_TURNING] / TURNING_RANGE_RAD, TURNING_BINS)
+        for (da in -1..1) {
+            for (dc in -1..1) {
+                for (dt in -1..1) {
+                    val bucket = buckets[key(a + da, c + dc, t + dt)] ?: continue
+                    candidates.addAll(bucket)
+                }
+            }
+        }
+        return candidates.size >= MIN_CANDIDATES
+    }
+
+    private fun grow() {
+        val capacity = rowIds.size * 2
+        matrix = matrix.copyOf(capacity * DIM)
+        suffixNorms = suffixNorms.copyOf(capacity * NORMS)
+        rowIds = rowIds.copyOf(capacity)
+        rowBuckets = rowBuckets.copyOf(capacity)
+        rowNames = rowNames.copyOf(capacity)
+        rowTypes = rowTypes.copyOf(capacity)
+        dotA = FloatArray(capacity)
+        dotB = FloatArray(capacity)
+    }
+
+    private fun bucketOf(features: FloatArray): Int = key(
+        bin(features[StrokeNormalizer.FEATURE_ASPECT], ASPECT_BINS),
+        bin(features[StrokeNormalizer.FEATURE_CLOSEDNESS], CLOSEDNESS_BINS),
+        bin(features[StrokeNormalizer.FEATURE_TURNING] / TURNING_RANGE_RAD, TURNING_BINS),
+    )
+
+    /** Growable list of row indices. */
+    private class IntList {
+        var items = IntArray(8)
+            private set
+        var size = 0
+            private set
+
+        fun add(value: Int) {
+            if (size == items.size) items = items.copyOf(size * 2)
+            items[size++] = value
+        }
+
+        fun addAll(other: IntList) {
+            if (size + other.size > items.size) items = items.copyOf(maxOf(items.size * 2, size + other.size))
+            other.items.copyInto(items, size, 0, other.size)
+            size += other.size
+        }
+
+        fun removeValue(value: Int) {
+            for (i in 0 until size) {
+                if (items[i] == value) {
+                    items[i] = items[--size]
+                    return
+                }
+            }
+        }
+
+        fun replaceValue(old: Int, new: Int) {
+            for (i in 0 until size) {
+                if (items[i] == old) {
+                    items[i] = new
+                    return
+                }
+            }
+        }
+
+        fun clear() {
+            size = 0
+        }
+    }
+
+    companion object {
+        private const val DIM = StrokeNormalizer.SAMPLE_COUNT * 2
+        private val NORMS = Protractor.blockCount(DIM) + 1
+        private const val INITIAL_ROWS = 16
+
+        /** Libraries up to this size are always scanned in full. */
+        private const val LINEAR_SCAN_LIMIT = 64
+
+        /** Minimum prefiltered candidates before the full scan is skipped. */
+        private const val MIN_CANDIDATES = 8
+
+        private const val ASPECT_BINS = 8
+        private const val CLOSEDNESS_BINS = 8
+        private const val TURNING_BINS = 16
+        // Quarter-turn bins up to four full turns.
+        private val TURNING_RANGE_RAD = (TURNING_BINS * PI / 2).toFloat()
+
+        private fun similarityToScore(similarity: Float): Float =
+            (1f - acos(similarity) / (PI.toFloat() / 2f)).coerceIn(0f, 1f)
+
+        /** Quantizes a unit-range feature; out-of-range values land in the edge bins. */
+        private fun bin(value: Float, bins: Int): Int = (value * bins).toInt().coerceIn(0, bins - 1)
+
+        // Neighbours outside the grid map to keys no bucket uses.
+        private fun key(aspect: Int, closedness: Int, turning: Int): Int =
+            (aspect + 1) * 10_000 + (closedness + 1) * 100 + (turning + 1)
+
+        /** Library pre-populated with the built-in line, circle, rectangle and zigzag. */
+        fun withDefaults(): TemplateLibrary = TemplateLibrary().apply {
+            add(
+                "line",
+                GestureType.LINE,
+                listOf(
+                    PathPoint(0f, 0f, 0L),
+                    PathPoint(100f, 0f, 10L),
+                ),
+            )
+            val steps = 64
+            add(
+                "circle",
+                GestureType.CIRCLE,
+                List(steps) { i ->
+                    val t = (2 * PI * i / steps).toFloat()
+                    PathPoint(kotlin.math.cos(t) * 50f, kotlin.math.sin(t) * 50f, i.toLong())
+                },
+            )
+            add(
+                "rectangle",
+                GestureType.RECTANGLE,
+                listOf(
+                    PathPoint(0f, 0f, 0L),
+                    PathPoint(100f, 0f, 10L),
+                    PathPoint(100f, 60f, 20L),
+                    PathPoint(0f, 60f, 30L),
+                    PathPoint(0f, 0f, 40L),
+                ),
+            )
+            add(
+                "zigzag",
+                GestureType.ZIGZAG,
+                listOf(
+                    PathPoint(0f, 0f, 0L),
+                    PathPoint(30f, 20f, 10L),
+                    PathPoint(60f, -20f, 20L),
+                    PathPoint(90f, 20f, 30L),
+                    PathPoint(120f, -20f, 40L),
+                ),
+            )
+        }
+    }
+}
+
+/** Mutable best-match slot reused across queries to keep recognition allocation-free. */
+internal class TemplateHit {
+    var name: String = ""
+    var type: GestureType = GestureType.UNKNOWN
+    var similarity: Float = -1f
+
+    fun reset() {
+        name = ""
+        type = GestureType.UNKNOWN
+        similarity = -1f
+    }
+}
@@ -0,0 +1,323 @@
+package com.dayushmand.pathsense.core
+
+import kotlinx.atomicfu.locks.SynchronizedObject
+import kotlinx.atomicfu.locks.synchronized
+import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.SupervisorJob
+import kotlinx.coroutines.cancel
+import kotlinx.coroutines.channels.Channel
+import kotlinx.coroutines.delay
+import kotlinx.coroutines.launch
+import kotlinx.coroutines.withContext
+import kotlin.math.abs
+import kotlin.math.ceil
+import kotlin.math.floor
+import kotlin.math.max
+import kotlin.math.roundToLong
+
+/**
+ * Touch-density heatmap aggregated across trackers, screens and sessions.
+ *
+ * [record] only copies a finished stroke's points into a staging batch, so
+ * it costs the caller a short lock and a copy. A background worker wakes at
+ * most every [BATCH_WINDOW_MS] and rasterizes the whole batch: each stroke
+ * adds 1 to every [cellPx] cell its segments pass through. Cells live in
+ * sparse square tiles of [TILE_CELLS]² counters per screen, allocated on
+ * first touch, so memory grows with the area touched, not the screen size.
+ *
+ * Strokes beyond [maxStagedPoints] waiting for the worker are dropped and
+ * counted in [droppedPoints] rather than buffered without bound.
+ */
+class TouchHeatmap(
+    val cellPx: Float = DEFAULT_CELL_PX,
+    val maxStagedPoints: Int = DEFAULT_MAX_STAGED_POINTS,
+) {
+    // Needed for Swift interop — KMM doesn't export default param values to ObjC/Swift
+    constructor() : this(DEFAULT_CELL_PX)
+
+    private val scope = CoroutineScope(SupervisorJob() + Dispatchers.Default)
+    private val wakeups = Channel<Unit>(Channel.CONFLATED)
+
+    // Staging is double-buffered: record() fills one batch while drain() rasterizes the other.
+    private val stagingLock = SynchronizedObject()
+    private var staging = Batch(maxStagedPoints)
+    private var spare = Batch(maxStagedPoints)
+    private var dropped = 0L
+
+    // Published tiles; held only to read them or to merge in a rasterized batch.
+    private val tilesLock = SynchronizedObject()
+    private val screens = HashMap<String, HashMap<Long, IntArray>>()
+
+    // Bumped by clear(), so a batch rasterized across it isn't published.
+    private var generation = 0L
+
+    // Held for a whole drain, so batches are rasterized one at a time into
+    // worker-owned delta tiles that readers never see.
+    private val drainLock = SynchronizedObject()
+    private val pending = HashMap<String, HashMap<Long, IntArray>>()
+    private val merged = ArrayList<IntArray>()
+    private val pool = ArrayList<IntArray>()
+
+    init {
+        require(cellPx > 0f) { "cellPx must be positive" }
+        scope.launch {
+            for (wakeup in wakeups) {
+                delay(BATCH_WINDOW_MS)
+                drain()
+            }
+        }
+    }
+
+    /** Points dropped because the worker fell [maxStagedPoints] behind. */
+    val droppedPoints: Long
+        get() = synchronized(stagingLock) { dropped }
+
+    /** Stages a finished stroke on [screen] for rasterization; any thread. */
+    fun record(screen: String, points: PointView) {
+        if (points.size == 0) return
+        synchronized(stagingLock) {
+            if (!staging.add(screen, points)) {
+                dropped += points.size
+                return
+            }
+        }
+        wakeups.trySend(Unit)
+    }
+
+    /** Rasterizes everything staged so far, without waiting for the batch window. */
+    suspend fun flush() {
+        withContext(Dispatchers.Default) { drain() }
+    }
+
+    /** Strokes that passed through the cell containing ([x], [y]) on [screen]. */
+    fun densityAt(screen: String, x: Float, y: Float): Int {
+        val cx = cellOf(x)
+        val cy = cellOf(y)
+        synchronized(tilesLock) {
+            val tile = screens[screen]?.get(tileKey(tileOf(cx), tileOf(cy))) ?: return 0
+            return tile[cellIndex(cx, cy)]
+        }
+    }
+
+    /** Screens with any density recorded. */
+    fun screenNames(): Set<String> = synchronized(tilesLock) { screens.keys.toSet() }
+
+    /** Tiles allocated for [screen]; memory is about 4 KB per tile. */
+    fun tileCount(screen: String): Int = synchronized(tilesLock) { screens[screen]?.size ?: 0 }
+
+    /**
+     * Writes the rasterized density to [sink]: `PSH` + version, the cell size
+     * in milli-px and [TILE_CELLS], then per screen its UTF-8 name and tiles.
+     * Each tile is its zigzag tile coordinates followed by its non-zero cells
+     * as (index gap, count) varint pairs. Staged strokes are not included
+     * until rasterized; call [flush] first for an exact export.
+     */
+    fun export(sink: ByteSink) {
+        val out = ExportBuffer(sink)
+        out.bytes(MAGIC, 0, MAGIC.size)
+        out.varint((cellPx * 1000f).roundToLong())
+        out.varint(TILE_CELLS.toLong())
+        synchronized(tilesLock) {
+            out.varint(screens.size.toLong())
+            for ((screen, tiles) in screens) {
+                val name = screen.encodeToByteArray()
+                out.varint(name.size.toLong())
+                out.bytes(name, 0, name.size)
+                out.varint(tiles.size.toLong())
+                for ((key, tile) in tiles) {
+                    out.varint(Varint.zigzag((key shr 32).toInt().toLong()))
+                    out.varint(Varint.zigzag(key.toInt().toLong()))
+                    out.varint(tile.count { it != 0 }.toLong())
+                    var previous = -1
+                    for (i in tile.indices) {
+                        if (tile[i] == 0) continue
+                        out.varint((i - previous - 1).toLong())
+                        out.varint(tile[i].toLong())
+                        previous = i
+                    }
+                }
+            }
+        }
+        out.flush()
+    }
+
+    /** Forgets all density and staged strokes. */
+    fun clear() {
+        synchronized(tilesLock) {
+            synchronized(stagingLock) { staging.clear() }
+            screens.clear()
+            generation++
+        }
+    }
+
+    /** Stops the worker; strokes staged but not yet rasterized are dropped. */
+    fun close() {
+        scope.cancel()
+        wakeups.close()
+    }
+
+    private fun drain() {
+        synchronized(drainLock) {
+            var generation = 0L
+            val batch = synchronized(tilesLock) {
+                generation = this.generation
+                synchronized(stagingLock) {
+                    val full = staging
+                    staging = spare
+                    spare = full
+                    full
+                }
+            }
+            if (batch.strokeCount == 0) return
+            for (s in 0 until batch.strokeCount) {
+                val tiles = pending.getOrPut(batch.screens[s]) { HashMap() }
+                rasterize(tiles, batch, batch.strokeStart(s), batch.strokeEnds[s])
+            }
+            batch.clear()
+            publish(generation)
+        }
+    }
+
+    /**
+     * Merges the batch's delta tiles into the published ones: the only tile
+     * work done under [tilesLock]. A tile new to its screen is handed over
+     * as is; merged deltas are zeroed outside the lock and pooled.
+     */
+    private fun publish(generation: Long) {
+        synchronized(tilesLock) {
+            for ((screen, deltas) in pending) {
+                if (generation != this.generation) {
+                    merged.addAll(deltas.values)
+                    continue
+                }
+                val tiles = screens.getOrPut(screen) { HashMap() }
+                for ((key, delta) in deltas) {
+                    val tile = tiles[key]
+                    if (tile == null) {
+                        tiles[key] = delta
+                        continue
+                    }
+                    for (i in delta.indices) tile[i] += delta[i]
+                    merged.add(delta)
+                }
+            }
+        }
+        pending.clear()
+        for (delta in merged) {
+            if (pool.size == MAX_POOLED_TILES) break
+            delta.fill(0)
+            pool.add(delta)
+        }
+        merged.clear()
+    }
+
+    /** Adds 1 to every cell the stroke's segments cross, counting each run of a cell once. */
+    private fun rasterize(tiles: HashMap<Long, IntArray>, batch: Batch, from: Int, until: Int) {
+        var lastCx = Int.MIN_VALUE
+        var lastCy = Int.MIN_VALUE
+        for (i in from until until) {
+            val ax = batch.xs[max(from, i - 1)]
+            val ay = batch.ys[max(from, i - 1)]
+            val bx = batch.xs[i]
+            val by = batch.ys[i]
+            // Half-cell steps: consecutive samples land in the same or adjacent cells.
+            val steps = max(1, ceil(max(abs(bx - ax), abs(by - ay)) * 2f / cellPx).toInt())
+            for (k in 0..steps) {
+                val f = k.toFloat() / steps
+                val cx = cellOf(ax + (bx - ax) * f)
+                val cy = cellOf(ay + (by - ay) * f)
+                if (cx == lastCx && cy == lastCy) continue
+                lastCx = cx
+                lastCy = cy
+                val tile = tiles.getOrPut(tileKey(tileOf(cx), tileOf(cy))) { newTile() }
+                tile[cellIndex(cx, cy)]++
+            }
+        }
+    }
+
+    private fun newTile(): IntArray = if (pool.isEmpty()) IntArray(TILE_CELLS * TILE_CELLS) else pool.removeAt(pool.size - 1)
+
+    private fun cellOf(v: Float): Int = floor(v / cellPx).toInt()
+
+    private fun tileOf(cell: Int): Int = cell.floorDiv(TILE_CELLS)
+
+    private fun cellIndex(cx: Int, cy: Int): Int = cy.mod(TILE_CELLS) * TILE_CELLS + cx.mod(TILE_CELLS)
+
+    private fun tileKey(tx: Int, ty: Int): Long = (tx.toLong() shl 32) or (ty.toLong() and 0xFFFFFFFFL)
+
+    /** Points of whole strokes, in primitive columns, with each stroke's end and screen. */
+    private class Batch(private val capacity: Int) {
+        val xs = FloatArray(capacity)
+        val ys = FloatArray(capacity)
+        var count = 0
+        var strokeEnds = IntArray(16)
+        val screens = ArrayList<String>()
+        var strokeCount = 0
+
+        fun strokeStart(s: Int): Int = if (s == 0) 0 else strokeEnds[s - 1]
+
+        fun add(screen: String, points: PointView): Boolean {
+            if (count + points.size > capacity) return false
+            for (i in 0 until points.size) {
+                xs[count + i] = points.x(i)
+                ys[count + i] = points.y(i)
+            }
+            count += points.size
+            if (strokeCount == strokeEnds.size) strokeEnds = strokeEnds.copyOf(strokeCount * 2)
+            strokeEnds[strokeCount++] = count
+            screens.add(screen)
+            return true
+        }
+
+        fun clear() {
+            count = 0
+            strokeCount = 0
+            screens.clear()
+        }
+    }
+
+    /** Varint writer staged through a fixed buffer, like [TouchRecorder]. */
+    private class ExportBuffer(private val sink: ByteSink) {
+        private val buffer = ByteArray(4096)
+        private var length = 0
+
+        fun varint(value: Long) {
+            if (buffer.size - length < Varint.MAX_BYTES) flush()
+            length = Varint.write(value, buffer, length)
+        }
+
+        fun bytes(src: ByteArray, offset: Int, count: Int) {
+            if (buffer.size - length < count) flush()
+            if (count > buffer.size) {
+                sink.write(src, offset, count)
+                return
+            }
+            src.copyInto(buffer, length, offset, offset + count)
+            length += count
+        }
+
+        fun flush() {
+            if (length == 0) return
+            sink.write(buffer, 0, length)
+            length = 0
+        }
+    }
+
+    companion object {
+        const val DEFAULT_CELL_PX = 8f
+        const val DEFAULT_MAX_STAGED_POINTS = 16_384
+
+        /** Cells per tile side. */
+        const val TILE_CELLS = 32
+
+        /** How long the worker waits after a stroke to batch further ones. */
+        const val BATCH_WINDOW_MS = 250L
+
+        // Zeroed delta tiles kept between drains; about 4 KB each.
+        private const val MAX_POOLED_TILES = 64
+
+        internal const val VERSION = 1
+        internal val MAGIC = byteArrayOf('P'.code.toByte(), 'S'.code.toByte(), 'H'.code.toByte(), VERSION.toByte())
+    }
+}
@@ -0,0 +1,82 @@
+package com.dayushmand.pathsense.core
+
+import kotlin.math.roundToLong
+
+/** Destination for recorded bytes, e.g. `ByteSink { b, off, len -> out.write(b, off, len) }`. */
+fun interface ByteSink {
+    fun write(bytes: ByteArray, offset: Int, length: Int)
+}
+
+enum class TouchAction { DOWN, MOVE, UP, CANCEL }
+
+/**
+ * Records raw touch input — call it with exactly what you feed
+ * [PathTracker] — as an append-only binary stream for [TouchReplayer].
+ *
+ * Format: a 4-byte header (`PST` + version) and the varint `unitsPerPx`, then
+ * one record per call. A record's first varint packs the zigzag time delta
+ * with the action in its low two bits; points follow as zigzag deltas of
+ * coordinates quantized to `1/unitsPerPx` px, so a typical move costs 3–5 bytes.
+ *
+ * Bytes are staged in a small fixed buffer and handed to [sink] whenever it
+ * fills, so long sessions never accumulate in memory. Call [flush] when done.
+ */
+class TouchRecorder(
+    private val sink: ByteSink,
+    val unitsPerPx: Int = DEFAULT_UNITS_PER_PX,
+) {
+    private val buffer = ByteArray(BUFFER_SIZE)
+    private var length = 0
+    private var lastQx = 0L
+    private var lastQy = 0L
+    private var lastT = 0L
+
+    init {
+        require(unitsPerPx > 0) { "unitsPerPx must be positive" }
+        MAGIC.copyInto(buffer)
+        length = Varint.write(unitsPerPx.toLong(), buffer, MAGIC.size)
+    }
+
+    fun onDown(p: PathPoint) = record(TouchAction.DOWN, p)
+
+    fun onMove(p: PathPoint) = record(TouchAction.MOVE, p)
+
+    fun onUp(p: PathPoint) = record(TouchAction.UP, p)
+
+    fun onCancel() {
+        reserve()
+        length = Varint.write(TouchAction.CANCEL.ordinal.toLong(), buffer, length)
+    }
+
+    /** Hands everything recorded so far to the sink. */
+    fun flush() {
+        if (length == 0) return
+        sink.write(buffer, 0, length)
+        length = 0
+    }
+
+    private fun record(action: TouchAction, p: PathPoint) {
+        reserve()
+        val qx = (p.x * unitsPerPx).roundToLong()
+        val qy = (p.y * unitsPerPx).roundToLong()
+        val head = (Varint.zigzag(p.tMillis - lastT) shl 2) or action.ordinal.toLong()
+        length = Varint.write(head, buffer, length)
+        length = Varint.write(Varint.zigzag(qx - lastQx), buffer, length)
+        length = Varint.write(Varint.zigzag(qy - lastQy), buffer, length)
+        lastQx = qx
+        lastQy = qy
+        lastT = p.tMillis
+    }
+
+    private fun reserve() {
+        if (BUFFER_SIZE - length < 3 * Varint.MAX_BYTES) flush()
+    }
+
+    companion object {
+        /** Default quantization: 1/8 px, far below touch digitizer noise. */
+        const val DEFAULT_UNITS_PER_PX = 8
+        internal const val VERSION = 1
+        internal val MAGIC = byteArrayOf('P'.code.toByte(), 'S'.code.toByte(), 'T'.code.toByte(), VERSION.toByte())
+        private const val BUFFER_SIZE = 4096
+    }
+}
@@ -0,0 +1,123 @@
+package com.dayushmand.pathsense.core
+
+import kotlinx.coroutines.delay
+import kotlin.time.TimeSource
+
+/**
+ * Source of recorded bytes: fills `bytes[offset until offset + length]` and
+ * returns how many were read, or -1 at the end of the stream.
+ */
+fun interface ByteSource {
+    fun read(bytes: ByteArray, offset: Int, length: Int): Int
+}
+
+/**
+ * Streams a [TouchRecorder] recording back one input at a time, reading
+ * through a small fixed buffer so recordings of any length replay in
+ * constant memory.
+ *
+ * Use [next] to step through records yourself, or [replayInto] to drive a
+ * [PathTracker] exactly as the original input did.
+ */
+class TouchReplayer(private val source: ByteSource) {
+    private val buffer = ByteArray(BUFFER_SIZE)
+    private var position = 0
+    private var limit = 0
+    private var started = false
+    private var qx = 0L
+    private var qy = 0L
+
+    /** Quantization of the recording, read from its header. */
+    var unitsPerPx = 0
+        private set
+
+    /** The current record, valid after [next] returned true. */
+    var action = TouchAction.CANCEL
+        private set
+    var x = 0f
+        private set
+    var y = 0f
+        private set
+    var tMillis = 0L
+        private set
+
+    /** Advances to the next record; false at the end of the recording. */
+    fun next(): Boolean {
+        if (!started) readHeader()
+        if (!fill()) return false
+        val head = readVarint()
+        action = ACTIONS[(head and 3L).toInt()]
+        tMillis += Varint.unzigzag(head ushr 2)
+        if (action != TouchAction.CANCEL) {
+            qx += Varint.unzigzag(readVarint())
+            qy += Varint.unzigzag(readVarint())
+            x = qx.toFloat() / unitsPerPx
+            y = qy.toFloat() / unitsPerPx
+        }
+        return true
+    }
+
+    /**
+     * Feeds the rest of the recording into [tracker], on the calling
+     * coroutine's thread. With [realTime] each input waits until its original
+     * offset from the first one; otherwise replay runs as fast as possible.
+     * Returns the number of inputs replayed.
+     */
+    suspend fun replayInto(tracker: PathTracker, realTime: Boolean = false): Int {
+        val clock = TimeSource.Monotonic.markNow()
+        var firstT = 0L
+        var count = 0
+        while (next()) {
+            if (realTime) {
+                if (count == 0) firstT = tMillis
+                val wait = (tMillis - firstT) - clock.elapsedNow().inWholeMilliseconds
+                if (wait > 0) delay(wait)
+            }
+            when (action) {
+                TouchAction.DOWN -> tracker.onDown(PathPoint(x, y, tMillis))
+                TouchAction.MOVE -> tracker.onMove(PathPoint(x, y, tMillis))
+                TouchAction.UP -> tracker.onUp(PathPoint(x, y, tMillis))
+                TouchAction.CANCEL -> tracker.onCancel()
+            }
+            count++
+        }
+        return count
+    }
+
+    private fun readHeader() {
+        started = true
+        for (expected in TouchRecorder.MAGIC) {
+            check(fill() && buffer[position++] == expected) { "Not a PathSense touch recording" }
+        }
+        unitsPerPx = readVarint().toInt()
+        check(unitsPerPx > 0) { "Corrupt touch recording header" }
+    }
+
+    private fun readVarint(): Long {
+        var result = 0L
+        var shift = 0
+        while (true) {
+            check(fill() && shift < 64) { "Truncated touch recording" }
+            val b = buffer[position++].toInt()
+            result = result or ((b and 0x7F).toLong() shl shift)
+            if (b and 0x80 == 0) return result
+            shift += 7
+        }
+    }
+
+    /** Ensures at least one unread byte; false at end of stream. */
+    private fun fill(): Boolean {
+        while (position == limit) {
+            val n = source.read(buffer, 0, BUFFER_SIZE)
+            if (n < 0) return false
+            position = 0
+            limit = n
+        }
+        return true
+    }
+
+    private companion object {
+        const val BUFFER_SIZE = 4096
+        val ACTIONS = TouchAction.values()
+    }
+}
@@ -0,0 +1,23 @@
+package com.dayushmand.pathsense.core
+
+/** LEB128 varints with zigzag signing, for the compact touch formats. */
+internal object Varint {
+    /** Longest encoding of a 64-bit value. */
+    const val MAX_BYTES = 10
+
+    fun zigzag(value: Long): Long = (value shl 1) xor (value shr 63)
+
+    fun unzigzag(value: Long): Long = (value ushr 1) xor -(value and 1L)
+
+    /** Writes [value] unsigned at [offset]; returns the offset just past it. */
+    fun write(value: Long, out: ByteArray, offset: Int): Int {
+        var v = value
+        var i = offset
+        while (v and 0x7FL.inv() != 0L) {
+            out[i++] = ((v and 0x7FL) or 0x80L).toByte()
+            v = v ushr 7
+        }
+        out[i++] = v.toByte()
+        return i
+    }
+}
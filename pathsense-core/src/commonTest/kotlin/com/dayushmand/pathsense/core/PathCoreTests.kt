@@ -1,5 +1,15 @@
 package com.dayushmand.pathsense.core
 
+import kotlinx.atomicfu.atomic
+import kotlinx.atomicfu.update
+import kotlinx.coroutines.CompletableDeferred
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.flow.asFlow
+import kotlinx.coroutines.flow.map
+import kotlinx.coroutines.flow.toList
+import kotlinx.coroutines.test.runTest
+import kotlinx.coroutines.withContext
+import kotlinx.coroutines.yield
 import kotlin.test.Test
 import kotlin.test.assertEquals
 import kotlin.test.assertTrue
@@ -29,6 +39,23 @@ class PathCoreTests {
         assertEquals(3f, list.last().x)
     }
 
+    @Test
+    fun ringBufferViewWrapsWithoutCopy() {
+        val buffer = PointBuffer(4)
+        for (i in 0 until 10) {
+            buffer.add(i.toFloat(), -i.toFloat(), i.toLong())
+        }
+        assertEquals(4, buffer.size)
+        for (i in 0 until buffer.size) {
+            assertEquals((6 + i).toFloat(), buffer.x(i))
+            assertEquals(-(6 + i).toFloat(), buffer.y(i))
+            assertEquals((6 + i).toLong(), buffer.tMillis(i))
+        }
+        assertEquals(9f, buffer.lastOrNull()?.x)
+        buffer.clear()
+        assertEquals(0, buffer.size)
+    }
+
     @Test
     fun metricsLine() {
         val points = listOf(
@@ -40,4 +67,661 @@ class PathCoreTests {
         assertEquals(10f, metrics.deltaX)
         assertEquals(0f, metrics.deltaY)
     }
+
+    @Test
+    fun streamingMetricsMatchFullRecomputeUnderEviction() {
+        val buffer = PointBuffer(16)
+        val accumulator = MetricsAccumulator(buffer)
+        val random = kotlin.random.Random(42)
+        var x = 0f
+        var y = 0f
+        for (i in 0 until 200) {
+            x += random.nextFloat() * 20f - 10f
+            y += random.nextFloat() * 20f - 10f
+            if (buffer.isFull) accumulator.onEvicting()
+            buffer.add(x, y, i * 8L)
+            accumulator.onAppended()
+
+            val expected = computeMetrics(buffer)
+            val actual = accumulator.snapshot()
+            assertEquals(expected.bbox, actual.bbox)
+            assertEquals(expected.start, actual.start)
+            assertEquals(expected.end, actual.end)
+            assertTrue(kotlin.math.abs(expected.length - actual.length) < 1e-2f)
+        }
+    }
+
+    @Test
+    fun deltaUpdatesCarryOnlyAppendedPoints() {
+        val tracker = PathTracker(PathConfig(smoothingWindow = 1, maxPoints = 3, updateMode = UpdateMode.DELTA))
+        val deltas = ArrayList<PathEvent.Appended>()
+        tracker.listener = { event -> if (event is PathEvent.Appended) deltas.add(event) }
+
+        tracker.onDown(PathPoint(0f, 0f, 0L))
+        for (i in 1..4) {
+            tracker.onMove(PathPoint(i * 10f, 0f, i * 20L))
+        }
+
+        assertEquals(5, deltas.size)
+        assertTrue(deltas.all { it.points.size == 1 })
+        assertEquals(listOf(1L, 2L, 3L, 4L, 5L), deltas.map { it.version })
+        assertEquals(2L, deltas.last().evictedCount)
+        assertEquals(40f, deltas.last().points.single().x)
+        assertEquals(tracker.pointsVersion, deltas.last().version)
+    }
+
+    @Test
+    fun normalizerIsTranslationAndScaleInvariant() {
+        val stroke = List(40) { i -> PathPoint(i * 3f, (i % 7) * 5f, i.toLong()) }
+        val moved = stroke.map { PathPoint(it.x * 2.5f + 300f, it.y * 2.5f - 80f, it.tMillis) }
+        val normalizer = StrokeNormalizer()
+        val a = normalizer.normalize(stroke.asPointView()).copyOf()
+        val b = normalizer.normalize(moved.asPointView())
+
+        var magnitude = 0f
+        for (i in a.indices) {
+            assertTrue(kotlin.math.abs(a[i] - b[i]) < 1e-4f)
+            magnitude += a[i] * a[i]
+        }
+        assertTrue(kotlin.math.abs(magnitude - 1f) < 1e-4f)
+    }
+
+    @Test
+    fun dollarOneRecognizesCircle() {
+        val match = DollarOneRecognizer().recognize(circleStroke())
+        assertEquals(GestureType.CIRCLE, match?.type)
+    }
+
+    @Test
+    fun templateLibraryPrefiltersLargeSetsAndSupportsRemoval() {
+        val library = TemplateLibrary.withDefaults()
+        val random = kotlin.random.Random(7)
+        repeat(300) { n ->
+            val scribble = List(12) { i -> PathPoint(random.nextFloat() * 100f, random.nextFloat() * 100f, i.toLong()) }
+            library.add("noise-$n", GestureType.UNKNOWN, scribble)
+        }
+        val circleId = library.add("my-circle", GestureType.CIRCLE, circleStroke())
+        assertEquals(305, library.size)
+
+        val recognizer = DollarOneRecognizer(library)
+        assertEquals(GestureType.CIRCLE, recognizer.recognize(circleStroke())?.type)
+
+        assertTrue(library.remove(circleId))
+        assertEquals("circle", recognizer.recognize(circleStroke())?.templateName)
+
+        val ranked = library.rank(circleStroke(), 3)
+        assertEquals(3, ranked.size)
+        assertEquals("circle", ranked.first().templateName)
+        assertTrue(ranked[0].score >= ranked[1].score && ranked[1].score >= ranked[2].score)
+    }
+
+    private fun circleStroke(): List<PathPoint> = List(48) { i ->
+        val t = 2.0 * kotlin.math.PI * i / 47
+        PathPoint(200f + 80f * kotlin.math.cos(t).toFloat(), 300f + 80f * kotlin.math.sin(t).toFloat(), i * 8L)
+    }
+
+    @Test
+    fun protractorRecoversSmallRotationsAndAbandonsLosers() {
+        val normalizer = StrokeNormalizer()
+        val stroke = List(32) { i -> PathPoint(i * 4f, if (i % 8 < 4) i * 2f else -i * 2f, i.toLong()) }
+        val template = normalizer.normalize(stroke.asPointView()).copyOf()
+        val templateNorms = Protractor.suffixNorms(template)
+
+        // Rotate the normalized vector by 20°: plain cosine drops, Protractor undoes it.
+        val angle = 20.0 * kotlin.math.PI / 180.0
+        val cos = kotlin.math.cos(angle).toFloat()
+        val sin = kotlin.math.sin(angle).toFloat()
+        val rotated = FloatArray(template.size)
+        for (i in template.indices step 2) {
+            rotated[i] = template[i] * cos - template[i + 1] * sin
+            rotated[i + 1] = template[i] * sin + template[i + 1] * cos
+        }
+        val rotatedNorms = Protractor.suffixNorms(rotated)
+
+        val similarity = Protractor.similarity(template, templateNorms, rotated, rotatedNorms, -1f)
+        assertTrue(similarity > 0.999f)
+        assertEquals(
+            Float.NEGATIVE_INFINITY,
+            Protractor.similarity(template, templateNorms, rotated, rotatedNorms, 1.5f),
+        )
+    }
+
+    @Test
+    fun pointCloudMatchesAnyDirectionAndMergesStrokes() {
+        val recognizer = PointCloudRecognizer.withDefaults(strokeWindowMs = 500L)
+        val reversed = circleStroke().reversed().mapIndexed { i, p -> p.copy(tMillis = i * 8L) }
+        assertEquals("circle", recognizer.recognize(reversed)?.templateName)
+
+        recognizer.reset()
+        recognizer.addTemplate(
+            "x",
+            GestureType.UNKNOWN,
+            listOf(
+                listOf(PathPoint(0f, 0f, 0L), PathPoint(100f, 100f, 10L)),
+                listOf(PathPoint(100f, 0f, 20L), PathPoint(0f, 100f, 30L)),
+            ),
+        )
+        // Drawn in the opposite order and direction, as two separate sessions.
+        recognizer.recognize(listOf(PathPoint(300f, 0f, 5_000L), PathPoint(0f, 300f, 5_100L)))
+        val merged = recognizer.recognize(listOf(PathPoint(300f, 300f, 5_300L), PathPoint(0f, 0f, 5_400L)))
+        assertEquals("x", merged?.templateName)
+
+        // A pause longer than the window starts a new gesture.
+        val alone = recognizer.recognize(listOf(PathPoint(0f, 0f, 9_000L), PathPoint(300f, 0f, 9_100L)))
+        assertEquals("line", alone?.templateName)
+    }
+
+    @Test
+    fun streamingResamplerKeepsSpacingForEarlyRecognition() {
+        val resampler = StreamingResampler(spacing = 6f, maxSamples = 100)
+        // Irregular raw steps along a line: samples still land every 6 px.
+        var x = 0f
+        var t = 0L
+        for (step in listOf(1f, 13f, 2f, 20f, 4f, 5f, 19f)) {
+            x += step
+            t += 8L
+            resampler.add(x, 0f, t)
+        }
+        assertEquals(11, resampler.size)
+        for (i in 1 until resampler.size) {
+            assertEquals(6f, resampler.x(i) - resampler.x(i - 1), 1e-3f)
+        }
+
+        val match = DollarOneRecognizer().recognizePartial(resampler.toList())
+        assertEquals(GestureType.LINE, match?.type)
+    }
+
+    @Test
+    fun multiPathTrackerReusesPooledSessionsPerPointer() {
+        val tracker = MultiPathTracker(PathConfig(smoothingWindow = 1), maxPointers = 2)
+        val started = ArrayList<Pair<Int, String>>()
+        tracker.listener = { pointerId, event ->
+            if (event is PathEvent.Started) started.add(pointerId to event.sessionId)
+        }
+
+        tracker.onDown(0, PathPoint(0f, 0f, 0L))
+        tracker.onDown(1, PathPoint(100f, 0f, 0L))
+        tracker.onDown(2, PathPoint(200f, 0f, 0L)) // pool exhausted: ignored
+        tracker.onMove(1, PathPoint(100f, 50f, 20L))
+        val view = tracker.pointsFor(1)
+        assertEquals(2, view?.size)
+        assertEquals(1, tracker.pointsFor(0)?.size)
+        assertEquals(null, tracker.pointsFor(2))
+
+        tracker.onUp(0, PathPoint(0f, 10f, 30L))
+        tracker.onDown(3, PathPoint(300f, 0f, 40L))
+        assertEquals(2, tracker.activePointerCount)
+        assertTrue(tracker.pointsFor(1) === view)
+        assertEquals(listOf(0, 1, 3), started.map { it.first })
+        assertEquals(3, started.map { it.second }.toSet().size)
+    }
+
+    @Test
+    fun statsCountGateRejectionsAndMoveLatency() {
+        val tracker = PathTracker(PathConfig(smoothingWindow = 1, collectStats = true))
+        tracker.onDown(PathPoint(0f, 0f, 0L))
+        tracker.onMove(PathPoint(50f, 0f, 2L)) // too soon for 120 Hz
+        tracker.onMove(PathPoint(1f, 0f, 20L)) // too close
+        tracker.onMove(PathPoint(50f, 0f, 40L))
+
+        val stats = tracker.statsSnapshot()!!
+        assertEquals(3L, stats.onMove.count)
+        assertEquals(1L, stats.rejectedByRate)
+        assertEquals(1L, stats.rejectedByDistance)
+        assertTrue(stats.listener.count >= 3L)
+        assertTrue(stats.onMove.percentileNanos(0.99) <= stats.onMove.maxNanos)
+
+        tracker.resetStats()
+        assertEquals(0L, tracker.statsSnapshot()!!.onMove.count)
+        assertEquals(null, PathTracker().statsSnapshot())
+        tracker.close()
+    }
+
+    @Test
+    fun touchRecordingRoundTripsCompactly() {
+        val bytes = ArrayList<Byte>()
+        val recorder = TouchRecorder({ b, off, len -> for (i in off until off + len) bytes.add(b[i]) })
+        val stroke = circleStroke()
+        recorder.onDown(stroke.first())
+        for (p in stroke.subList(1, stroke.size - 1)) recorder.onMove(p)
+        recorder.onUp(stroke.last())
+        recorder.onCancel()
+        recorder.flush()
+        assertTrue(bytes.size < stroke.size * 6)
+
+        val data = bytes.toByteArray()
+        var read = 0
+        val replayer = TouchReplayer { b, off, len ->
+            if (read == data.size) {
+                -1
+            } else {
+                // Dribble a few bytes at a time to exercise refills mid-record.
+                val n = minOf(len, 3, data.size - read)
+                data.copyInto(b, off, read, read + n)
+                read += n
+                n
+            }
+        }
+        for ((i, p) in stroke.withIndex()) {
+            assertTrue(replayer.next())
+            val expected = when (i) {
+                0 -> TouchAction.DOWN
+                stroke.size - 1 -> TouchAction.UP
+                else -> TouchAction.MOVE
+            }
+            assertEquals(expected, replayer.action)
+            assertEquals(p.x, replayer.x, 1f / 16f)
+            assertEquals(p.y, replayer.y, 1f / 16f)
+            assertEquals(p.tMillis, replayer.tMillis)
+        }
+        assertTrue(replayer.next())
+        assertEquals(TouchAction.CANCEL, replayer.action)
+        assertTrue(!replayer.next())
+    }
+
+    @Test
+    fun batchAnalyzerScoresEveryStrokeAcrossWorkers() = runTest {
+        val circle = circleStroke()
+        val strokes = (0L until 40L).asFlow().map { id ->
+            val points = if (id % 2 == 0L) circle else List(32) { i -> PathPoint(i * 5f, i * 2f, i * 8L) }
+            BatchStroke(
+                id,
+                FloatArray(points.size) { points[it].x },
+                FloatArray(points.size) { points[it].y },
+                LongArray(points.size) { points[it].tMillis },
+            )
+        }
+
+        val results = BatchAnalyzer(workers = 4).analyze(strokes).toList()
+
+        assertEquals((0L until 40L).toList(), results.map { it.id }.sorted())
+        for (result in results) {
+            val expected = if (result.id % 2 == 0L) GestureType.CIRCLE else GestureType.LINE
+            assertEquals(expected, result.match?.type)
+            assertTrue(result.metrics.length > 0f)
+        }
+    }
+
+    @Test
+    fun decimationKeepsWholeStrokeWithinBudget() {
+        val config = PathConfig(
+            smoothingWindow = 1,
+            maxPoints = 64,
+            overflowPolicy = OverflowPolicy.DECIMATE,
+            updateMode = UpdateMode.DELTA,
+        )
+        val session = PathSession(config)
+        val appended = ArrayList<PathEvent.Appended>()
+
+        // Three laps of a big circle: far more points than the buffer holds.
+        val points = List(400) { i ->
+            val t = 2.0 * kotlin.math.PI * i / 133
+            PathPoint(500f + 200f * kotlin.math.cos(t).toFloat(), 500f + 200f * kotlin.math.sin(t).toFloat(), i * 10L)
+        }
+        session.start(points.first())
+        val id = session.id!!
+        for (p in points.drop(1)) {
+            if (session.move(p)) appended.add(session.update(id) as PathEvent.Appended)
+        }
+
+        val view = session.buffer
+        assertTrue(view.size <= 64)
+        assertEquals(points.first(), view.pointAt(0))
+        assertEquals(points.last(), view.pointAt(view.size - 1))
+        for (i in 1 until view.size) {
+            assertTrue(MathUtils.distance(view.x(i - 1), view.y(i - 1), view.x(i), view.y(i)) >= 6f)
+        }
+        // Compaction looks like evicting everything, then re-appending the survivors.
+        val resync = appended.first { it.evictedCount > 0 }
+        assertEquals(resync.version - resync.evictedCount, resync.points.size.toLong())
+        val streamed = session.metrics.snapshot()
+        val full = computeMetrics(view)
+        assertEquals(full.bbox, streamed.bbox)
+        assertEquals(full.length, streamed.length, 0.1f)
+    }
+
+    @Test
+    fun adaptiveFiltersLagLessAndPredictAhead() {
+        // Steady 1 px/ms swipe sampled every 10 ms.
+        val points = List(40) { i -> PathPoint(i * 10f, 100f, i * 10L) }
+        fun lastOf(smoothing: SmoothingFilter): PathSession {
+            val session = PathSession(PathConfig(smoothing = smoothing, predictionMs = 20))
+            session.start(points.first())
+            for (p in points.drop(1)) session.move(p)
+            return session
+        }
+        val raw = points.last().x
+
+        val average = lastOf(SmoothingFilter.MovingAverage)
+        val oneEuro = lastOf(SmoothingFilter.OneEuro())
+        val kalman = lastOf(SmoothingFilter.Kalman())
+        val averageLag = raw - average.buffer.x(average.buffer.size - 1)
+        assertEquals(30f, averageLag, 1f)
+        assertTrue(raw - oneEuro.buffer.x(oneEuro.buffer.size - 1) < averageLag / 2f + 1f)
+        assertEquals(raw, kalman.buffer.x(kalman.buffer.size - 1), 1f)
+
+        // Predictions run ahead of the newest raw input.
+        assertTrue(oneEuro.predictedPoint!!.x > raw)
+        assertEquals(raw + 20f, kalman.predictedPoint!!.x, 1f)
+        assertEquals(100f, kalman.predictedPoint!!.y, 0.01f)
+
+        kalman.end(points.last())
+        assertEquals(null, kalman.predictedPoint)
+    }
+
+    @Test
+    fun moveBatchGatesInNanosAndEmitsOneUpdate() {
+        val tracker = PathTracker(
+            PathConfig(samplingHz = 240, smoothingWindow = 1, collectStats = true, updateMode = UpdateMode.DELTA),
+        )
+        val deltas = ArrayList<PathEvent.Appended>()
+        tracker.listener = { event -> if (event is PathEvent.Appended) deltas.add(event) }
+        tracker.onDown(PathPoint(0f, 0f, 0L))
+        deltas.clear()
+
+        // Eight samples 4.2 ms apart, then one only 4.0 ms later: under the
+        // 240 Hz interval (4.17 ms), which whole milliseconds can't resolve.
+        val xs = FloatArray(9) { (it + 1) * 10f }
+        val ys = FloatArray(9)
+        val ts = LongArray(9) { (it + 1) * 4_200_000L }
+        ts[8] = ts[7] + 4_000_000L
+        tracker.onMoveBatch(xs, ys, ts, 9)
+
+        assertEquals(1, deltas.size)
+        assertEquals(8, deltas.single().points.size)
+        assertEquals(80f, deltas.single().points.last().x)
+        assertEquals(33L, deltas.single().points.last().tMillis)
+        val stats = tracker.statsSnapshot()!!
+        assertEquals(1L, stats.rejectedByRate)
+        assertEquals(1L, stats.onMove.count)
+        tracker.close()
+    }
+
+    @Test
+    fun segmentGridAnswersHitTestsAndRegionCrossings() {
+        val config = PathConfig(smoothingWindow = 1, maxPoints = 50, spatialCellPx = 32f)
+        val tracker = PathTracker(config)
+        val regionEvents = ArrayList<PathEvent>()
+        tracker.listener = { event ->
+            if (event is PathEvent.RegionEntered || event is PathEvent.RegionExited) regionEvents.add(event)
+        }
+        tracker.addRegion("gate", RectF(395f, 80f, 405f, 120f))
+        tracker.addRegion("far", RectF(0f, 900f, 50f, 950f))
+        tracker.addRegion("end", RectF(1180f, 90f, 1220f, 110f))
+
+        // A 1200 px swipe: 121 points, so the first 71 are evicted on the way.
+        tracker.onDown(PathPoint(0f, 100f, 0L))
+        for (i in 1..120) tracker.onMove(PathPoint(i * 10f, 100f, i * 10L))
+
+        val points = tracker.points
+        for ((qx, qy) in listOf(1000f to 140f, 0f to 0f, 1500f to 100f, 903f to 97f)) {
+            val linear = SegmentGrid.scanNearest(points, qx, qy)
+            assertEquals(points.pointAt(linear), tracker.nearestPoint(qx, qy))
+        }
+        assertEquals(PathPoint(710f, 100f, 710L), tracker.nearestPoint(0f, 0f))
+        assertTrue(tracker.crosses(RectF(1000f, 0f, 1001f, 500f)))
+        assertTrue(!tracker.crosses(RectF(0f, 0f, 600f, 500f))) // evicted part
+        assertTrue(!tracker.crosses(RectF(800f, 101f, 900f, 200f)))
+
+        tracker.onUp(PathPoint(1210f, 100f, 1210L))
+        val expected = listOf<PathEvent>(
+            PathEvent.RegionEntered("", "gate"),
+            PathEvent.RegionExited("", "gate"),
+            PathEvent.RegionEntered("", "end"),
+            PathEvent.RegionExited("", "end"),
+        )
+        assertEquals(expected, regionEvents.map {
+            when (it) {
+                is PathEvent.RegionEntered -> it.copy(sessionId = "")
+                is PathEvent.RegionExited -> it.copy(sessionId = "")
+                else -> it
+            }
+        })
+        tracker.close()
+    }
+
+    @Test
+    fun kinematicsKernelMeasuresSpeedTurningAndStraightness() {
+        // Constant 1 px/ms, with one right-angle turn; ring wraps so the copy must unwrap.
+        val buffer = PointBuffer(5)
+        buffer.add(PathPoint(-10f, 0f, -10L))
+        for (p in listOf(
+            PathPoint(0f, 0f, 0L),
+            PathPoint(10f, 0f, 10L),
+            PathPoint(20f, 0f, 20L),
+            PathPoint(20f, 10f, 30L),
+            PathPoint(20f, 20f, 40L),
+        )) {
+            buffer.add(p)
+        }
+        val columns = buffer.copyColumns()
+        assertEquals(buffer.toList(), List(columns.size) { columns.pointAt(it) })
+
+        val k = KinematicsKernel().compute(columns)
+        assertEquals(1000f, k.peakSpeed, 0.01f)
+        assertEquals(1000f, k.p90Speed, 0.01f)
+        assertEquals(0f, k.peakAcceleration, 0.01f)
+        assertEquals(0f, k.rmsJerk, 0.01f)
+        assertEquals(90f, k.totalTurningDeg, 0.01f)
+        assertEquals((kotlin.math.PI / 2 / 40).toFloat(), k.meanCurvature, 1e-5f)
+        assertEquals(kotlin.math.sqrt(800f) / 40f, k.straightness, 1e-5f)
+        // Two straight continuations in the 0° bin, one clockwise (on-screen) quarter turn at +90°.
+        assertEquals(listOf(0, 0, 0, 0, 2, 0, 1, 0), k.turningHistogram)
+
+        // Live snapshots copy nothing on the main thread; the worker copies when it takes one.
+        val session = PathSession(PathConfig(kinematics = true))
+        session.start(PathPoint(0f, 0f, 0L))
+        session.move(PathPoint(30f, 0f, 100L))
+        session.move(PathPoint(60f, 0f, 200L))
+        val first = session.id!!
+        val live = session.liveSnapshot(first)
+        assertEquals(null, live.columns)
+        val taken = live.liveColumns?.copyFor(first)
+        assertEquals(session.buffer.toList(), taken?.let { c -> List(c.size) { c.pointAt(it) } })
+        session.end(PathPoint(60f, 0f, 300L))
+        session.start(PathPoint(0f, 0f, 400L))
+        assertEquals(null, live.liveColumns?.copyFor(first))
+    }
+
+    @Test
+    fun gestureHistoryCompressesAndEvictsLeastRecentlyUsed() {
+        // One 5000 px jump forces the int16 escape.
+        val stroke = List(100) { i -> PathPoint(i * 3.3f + if (i == 50) 5000f else 0f, 200f - i * 1.7f, 1000L + i * 8) }
+        val history = GestureHistory(arenaBytes = 2048, maxStrokes = 8)
+        assertTrue(history.record("a", stroke.asPointView()))
+        val bytes = history.usedBytes
+        assertTrue(bytes < stroke.size * 6, "used $bytes bytes")
+
+        val a = history.find("a")!!
+        assertEquals(stroke.size, a.size)
+        for (i in stroke.indices) {
+            assertEquals(stroke[i].x, a.x(i), 1f / 16)
+            assertEquals(stroke[i].y, a.y(i), 1f / 16)
+            assertEquals(stroke[i].tMillis, a.tMillis(i))
+        }
+        assertEquals(stroke[3].x, a.x(3), 1f / 16) // stepping back rewinds
+
+        // Fill the arena; "a" was just read, so "b" is the least recently used.
+        assertTrue(history.record("b", stroke.asPointView()))
+        history.find("a")
+        for (id in listOf("c", "d", "e")) assertTrue(history.record(id, stroke.asPointView()))
+        assertEquals(null, history.find("b"))
+        assertTrue(history.find("a") != null)
+        assertTrue(history.usedBytes <= 2048)
+        assertEquals(stroke.last().tMillis, history.strokeAt(history.size - 1).let { it.tMillis(it.size - 1) })
+    }
+
+    @Test
+    fun heatmapRasterizesStrokesIntoSparseTiles() = runTest {
+        val heatmap = TouchHeatmap(cellPx = 10f)
+        // Two horizontal swipes over the same row, one vertical across it, on another screen too.
+        val row = List(11) { i -> PathPoint(i * 20f + 5f, 105f, i * 8L) }
+        val column = listOf(PathPoint(55f, 0f, 0L), PathPoint(55f, 400f, 40L))
+        heatmap.record("main", row.asPointView())
+        heatmap.record("main", row.asPointView())
+        heatmap.record("main", column.asPointView())
+        heatmap.record("settings", column.asPointView())
+        heatmap.flush()
+
+        assertEquals(3, heatmap.densityAt("main", 55f, 105f))
+        assertEquals(2, heatmap.densityAt("main", 150f, 109f)) // between samples: segments count too
+        assertEquals(1, heatmap.densityAt("main", 55f, 250f))
+        assertEquals(0, heatmap.densityAt("main", 150f, 250f))
+        assertEquals(1, heatmap.densityAt("settings", 55f, 0f))
+        // 32 cells of 10 px per tile: the column spans tiles 0 and 1 vertically.
+        assertEquals(2, heatmap.tileCount("main"))
+        assertEquals(setOf("main", "settings"), heatmap.screenNames())
+
+        val bytes = ArrayList<Byte>()
+        heatmap.export { b, off, len -> for (i in off until off + len) bytes.add(b[i]) }
+        assertEquals(TouchHeatmap.MAGIC.toList(), bytes.take(4))
+        // 102 non-zero cells at about 2 bytes each, plus headers.
+        assertTrue(bytes.size < 300, "exported ${bytes.size} bytes")
+        heatmap.close()
+    }
+
+    @Test
+    fun fanOutReturnsEarlyWithoutReenteringABusyRecognizer() = runTest {
+        val released = atomic(false)
+        val calls = atomic(0)
+        val active = atomic(0)
+        val maxActive = atomic(0)
+        val slow = object : GestureRecognizer {
+            override fun recognize(points: List<PathPoint>): GestureMatch? {
+                calls.incrementAndGet()
+                val now = active.incrementAndGet()
+                maxActive.update { maxOf(it, now) }
+                while (!released.value) {
+                    // Blocks like a real recognizer would; cancellation can't interrupt it.
+                }
+                active.decrementAndGet()
+                return GestureMatch(GestureType.UNKNOWN, 0.1f, "slow")
+            }
+
+            override fun recognizePartial(points: List<PathPoint>): GestureMatch? = recognize(points)
+        }
+        val analyzer = GestureAnalyzer(PathConfig(earlyRecognitionThreshold = 0.5f))
+        analyzer.add {
+            // Answers only once the slow one is in, so it is never cancelled before starting.
+            while (calls.value == 0) {
+                // Spin.
+            }
+            GestureMatch(GestureType.LINE, 1f, "fast")
+        }
+        analyzer.add(slow)
+        val points = List(8) { i -> PathPoint(i * 10f, 0f, i * 8L) }
+
+        withContext(Dispatchers.Default) {
+            // The good-enough match returns while the slow recognizer is still inside its call.
+            assertEquals("fast", analyzer.fanOut(points, partial = false)?.algorithm)
+
+            // Neither a prediction nor a final pass may enter it again meanwhile.
+            assertEquals("fast", analyzer.fanOut(points, partial = true)?.algorithm)
+            assertEquals("fast", analyzer.fanOut(points, partial = false)?.algorithm)
+            assertEquals(1, calls.value)
+
+            // The final stroke still reaches it once it is free; only the late result is dropped.
+            released.value = true
+            while (calls.value < 2 || active.value > 0) yield()
+        }
+        assertEquals(1, maxActive.value)
+    }
+
+    @Test
+    fun throwingRecognizerCountsAsNoMatch() = runTest {
+        val stats = StatsRecorder()
+        val analyzer = GestureAnalyzer(PathConfig(), stats)
+        val broken = GestureRecognizer { error("broken recognizer") }
+        val ok = GestureRecognizer { GestureMatch(GestureType.LINE, 0.8f, "ok") }
+        analyzer.add(broken)
+        analyzer.add(ok)
+        val points = List(8) { i -> PathPoint(i * 10f, 0f, i * 8L) }
+
+        withContext(Dispatchers.Default) {
+            // Fanned out, and alone on the inline path: neither escapes to the worker.
+            assertEquals("ok", analyzer.fanOut(points, partial = false)?.algorithm)
+            analyzer.remove(ok)
+            assertEquals(null, analyzer.fanOut(points, partial = false))
+        }
+        assertEquals(2L, stats.snapshot().recognizerFailures)
+    }
+
+    @Test
+    fun throwingTrackerDoesNotStallTheSharedEngine() = runTest {
+        val snapshot = PathSnapshot("a", computeMetrics(listOf(PathPoint(0f, 0f, 0L))), isFinal = true)
+        val failingCalls = atomic(0)
+        val failed = CompletableDeferred<Unit>()
+        // Stands in for a tracker whose listener throws during delivery.
+        val failing = AnalysisMailbox(slots = 1) { _, _, _ ->
+            failingCalls.incrementAndGet()
+            failed.complete(Unit)
+            error("listener failed")
+        }
+        val delivered = CompletableDeferred<String>()
+        val healthy = AnalysisMailbox(slots = 1) { _, _, s -> delivered.complete(s.sessionId) }
+
+        failing.postFinal(0, 0, snapshot)
+        failed.await()
+        healthy.postFinal(0, 0, snapshot.copy(sessionId = "b"))
+        assertEquals("b", delivered.await())
+
+        // The failing tracker's mailbox was closed; its later work is dropped.
+        failing.postFinal(0, 0, snapshot)
+        assertEquals(1, failingCalls.value)
+        healthy.close()
+    }
+
+    @Test
+    fun pointsListenersFireOnChangesIndependentlyOfTheListener() {
+        val tracker = PathTracker(PathConfig(minDistancePx = 5f))
+        var changes = 0
+        val redraw: () -> Unit = { changes++ }
+        tracker.addPointsListener(redraw)
+        var strokeSizes = emptyList<Int>()
+        tracker.addStrokeListener { points -> strokeSizes = strokeSizes + points.size }
+        // Replacing the app listener must not unhook a renderer.
+        tracker.listener = {}
+
+        tracker.onDown(PathPoint(0f, 0f, 0L))
+        tracker.onMove(PathPoint(1f, 0f, 100L)) // under minDistancePx: no new point
+        tracker.onMove(PathPoint(20f, 0f, 200L))
+        tracker.onUp(PathPoint(40f, 0f, 300L))
+        tracker.clearPoints()
+        assertEquals(4, changes)
+        assertEquals(listOf(3), strokeSizes)
+
+        tracker.removePointsListener(redraw)
+        tracker.onDown(PathPoint(0f, 0f, 400L))
+        assertEquals(4, changes)
+        tracker.close()
+    }
+
+    @Test
+    fun conflatedLiveSnapshotKeepsItsEarlyRecognitionCandidate() = runTest {
+        val metrics = computeMetrics(listOf(PathPoint(0f, 0f, 0L)))
+        // Park the shared engine so the next two posts land before any drain.
+        val entered = CompletableDeferred<Unit>()
+        val released = atomic(false)
+        val blocker = AnalysisMailbox(slots = 1) { _, _, _ ->
+            entered.complete(Unit)
+            while (!released.value) {
+                // Spin.
+            }
+        }
+        val received = CompletableDeferred<PathSnapshot>()
+        val mailbox = AnalysisMailbox(slots = 1) { _, _, s -> received.complete(s) }
+        blocker.postLive(0, 0, PathSnapshot("x", metrics, isFinal = false))
+        entered.await()
+
+        val candidate = listOf(PathPoint(1f, 2f, 3L), PathPoint(4f, 5f, 6L))
+        mailbox.postLive(0, 0, PathSnapshot("a", metrics, isFinal = false, points = candidate))
+        mailbox.postLive(0, 0, PathSnapshot("a", metrics, isFinal = false, postedNanos = 7L))
+        released.value = true
+
+        val drained = received.await()
+        assertEquals(7L, drained.postedNanos)
+        assertEquals(candidate, drained.points)
+        blocker.close()
+        mailbox.close()
+    }
 }
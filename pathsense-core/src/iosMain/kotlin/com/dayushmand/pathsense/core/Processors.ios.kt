@@ -0,0 +1,6 @@
+package com.dayushmand.pathsense.core
+
+import platform.Foundation.NSProcessInfo
+
+internal actual fun availableProcessors(): Int =
+    NSProcessInfo.processInfo.activeProcessorCount.toInt()
@@ -0,0 +1,30 @@
+package com.dayushmand.pathsense.core
+
+import kotlinx.benchmark.Benchmark
+import kotlinx.benchmark.Param
+import kotlinx.benchmark.Scope
+import kotlinx.benchmark.Setup
+import kotlinx.benchmark.State
+
+/** Whole-path passes: resampling for recognition and full metrics recompute. */
+@State(Scope.Benchmark)
+class PathAnalysisBenchmark {
+    @Param("64", "500", "5000")
+    var pointCount = 0
+
+    @Param("LINE", "CIRCLE", "ZIGZAG", "HANDWRITING")
+    var kind = StrokeKind.LINE
+
+    private lateinit var stroke: List<PathPoint>
+
+    @Setup
+    fun setUp() {
+        stroke = SyntheticStrokes.generate(kind, pointCount, seed = 3)
+    }
+
+    @Benchmark
+    fun resample(): List<PathPoint> = Resampler.resample(stroke, 64)
+
+    @Benchmark
+    fun metrics(): PathMetrics = computeMetrics(stroke)
+}
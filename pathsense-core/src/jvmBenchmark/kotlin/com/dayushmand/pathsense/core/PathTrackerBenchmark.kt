@@ -0,0 +1,43 @@
+package com.dayushmand.pathsense.core
+
+import kotlinx.benchmark.Benchmark
+import kotlinx.benchmark.Param
+import kotlinx.benchmark.Scope
+import kotlinx.benchmark.Setup
+import kotlinx.benchmark.State
+import kotlinx.benchmark.TearDown
+
+/** Main-thread cost of one accepted `onMove`, with the ring full at [maxPoints]. */
+@State(Scope.Benchmark)
+class PathTrackerBenchmark {
+    @Param("100", "500", "5000")
+    var maxPoints = 0
+
+    private lateinit var tracker: PathTracker
+    private lateinit var stroke: List<PathPoint>
+    private var index = 0
+    private var time = 0L
+
+    @Setup
+    fun setUp() {
+        tracker = PathTracker(PathConfig(maxPoints = maxPoints, updateMode = UpdateMode.DELTA))
+        stroke = SyntheticStrokes.generate(StrokeKind.HANDWRITING, 4096, seed = 1)
+        tracker.onDown(stroke[0])
+        // Fill the ring so every measured move also evicts.
+        repeat(maxPoints) { onMove() }
+    }
+
+    @TearDown
+    fun tearDown() {
+        tracker.close()
+    }
+
+    @Benchmark
+    fun onMove() {
+        val p = stroke[index]
+        index = (index + 1) % stroke.size
+        // Step time past the sampling throttle so every move is accepted.
+        time += 10L
+        tracker.onMove(PathPoint(p.x + (time % 7), p.y, time))
+    }
+}
@@ -0,0 +1,35 @@
+package com.dayushmand.pathsense.core
+
+import kotlinx.benchmark.Benchmark
+import kotlinx.benchmark.Param
+import kotlinx.benchmark.Scope
+import kotlinx.benchmark.Setup
+import kotlinx.benchmark.State
+
+/** $1 recognition throughput as the template set grows. */
+@State(Scope.Benchmark)
+class RecognitionBenchmark {
+    @Param("4", "100", "1000")
+    var templateCount = 0
+
+    @Param("CIRCLE", "HANDWRITING")
+    var kind = StrokeKind.CIRCLE
+
+    private lateinit var recognizer: DollarOneRecognizer
+    private lateinit var stroke: List<PathPoint>
+
+    @Setup
+    fun setUp() {
+        val library = TemplateLibrary.withDefaults()
+        var seed = 0
+        while (library.size < templateCount) {
+            library.add("synthetic-$seed", GestureType.UNKNOWN, SyntheticStrokes.generate(StrokeKind.HANDWRITING, 96, seed))
+            seed++
+        }
+        recognizer = DollarOneRecognizer(library)
+        stroke = SyntheticStrokes.generate(kind, 128, seed = 7)
+    }
+
+    @Benchmark
+    fun recognize(): GestureMatch? = recognizer.recognize(stroke)
+}
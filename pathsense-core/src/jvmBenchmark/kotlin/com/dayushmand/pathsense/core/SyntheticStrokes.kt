@@ -0,0 +1,53 @@
+package com.dayushmand.pathsense.core
+
+import kotlin.math.PI
+import kotlin.math.cos
+import kotlin.math.sin
+import kotlin.random.Random
+
+/** Shapes the benchmark strokes are drawn from. */
+enum class StrokeKind { LINE, CIRCLE, ZIGZAG, HANDWRITING }
+
+/**
+ * Deterministic stroke generator for benchmarks: the same kind, size and seed
+ * always yield the same points, at a steady 8 ms (~120 Hz) sample interval.
+ */
+object SyntheticStrokes {
+    private const val SAMPLE_INTERVAL_MS = 8L
+
+    fun generate(kind: StrokeKind, count: Int, seed: Int = 0): List<PathPoint> {
+        val random = Random(seed)
+        return when (kind) {
+            StrokeKind.LINE -> List(count) { i ->
+                point(i, 100f + i * 3f, 200f + i * 1.5f)
+            }
+            StrokeKind.CIRCLE -> List(count) { i ->
+                val t = 2.0 * PI * i / (count - 1).coerceAtLeast(1)
+                point(i, 300f + 120f * cos(t).toFloat(), 400f + 120f * sin(t).toFloat())
+            }
+            StrokeKind.ZIGZAG -> List(count) { i ->
+                val phase = i % 16
+                val y = if (phase < 8) phase * 10f else (16 - phase) * 10f
+                point(i, 50f + i * 4f, 300f + y)
+            }
+            StrokeKind.HANDWRITING -> handwriting(count, random)
+        }
+    }
+
+    /** Loopy cursive-like trace: drifting curvature plus jitter, like a finger. */
+    private fun handwriting(count: Int, random: Random): List<PathPoint> {
+        var x = 100f
+        var y = 300f
+        var heading = 0.0
+        var curvature = 0.0
+        return List(count) { i ->
+            curvature = (curvature + (random.nextDouble() - 0.5) * 0.08).coerceIn(-0.35, 0.35)
+            heading += curvature
+            x += 4f * cos(heading).toFloat() + (random.nextFloat() - 0.5f)
+            y += 4f * sin(heading).toFloat() + (random.nextFloat() - 0.5f)
+            point(i, x, y)
+        }
+    }
+
+    private fun point(i: Int, x: Float, y: Float) = PathPoint(x, y, i * SAMPLE_INTERVAL_MS)
+}
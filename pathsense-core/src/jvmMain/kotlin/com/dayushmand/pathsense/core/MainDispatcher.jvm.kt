@@ -0,0 +1,7 @@
+package com.dayushmand.pathsense.core
+
+import kotlinx.coroutines.CoroutineDispatcher
+import kotlinx.coroutines.Dispatchers
+
+// A plain JVM has no UI thread; events are delivered from the shared pool.
+internal actual val MainDispatcher: CoroutineDispatcher = Dispatchers.Default
@@ -0,0 +1,3 @@
+package com.dayushmand.pathsense.core
+
+internal actual fun currentTimeMillis(): Long = System.currentTimeMillis()
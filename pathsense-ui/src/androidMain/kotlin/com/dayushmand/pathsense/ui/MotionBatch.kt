@@ -0,0 +1,53 @@
+package com.dayushmand.pathsense.ui
+
+import android.os.Build
+import android.view.MotionEvent
+
+/**
+ * Reused primitive columns for handing a [MotionEvent]'s samples to
+ * `PathTracker.onMoveBatch` in one call, instead of one `onMove` each.
+ */
+internal class MotionBatch {
+    var xs = FloatArray(INITIAL_CAPACITY)
+        private set
+    var ys = FloatArray(INITIAL_CAPACITY)
+        private set
+    var nanos = LongArray(INITIAL_CAPACITY)
+        private set
+
+    /**
+     * Copies [pointerIndex]'s historical samples (plus the current one when
+     * [includeCurrent]) into the columns; returns the sample count.
+     * Timestamps are nanoseconds, at full precision on API 34+.
+     */
+    fun fill(event: MotionEvent, pointerIndex: Int, includeCurrent: Boolean): Int {
+        val history = event.historySize
+        val count = if (includeCurrent) history + 1 else history
+        if (count > xs.size) {
+            xs = FloatArray(count)
+            ys = FloatArray(count)
+            nanos = LongArray(count)
+        }
+        val precise = Build.VERSION.SDK_INT >= Build.VERSION_CODES.UPSIDE_DOWN_CAKE
+        for (h in 0 until history) {
+            xs[h] = event.getHistoricalX(pointerIndex, h)
+            ys[h] = event.getHistoricalY(pointerIndex, h)
+            nanos[h] = if (precise) {
+                event.getHistoricalEventTimeNanos(h)
+            } else {
+                event.getHistoricalEventTime(h) * NANOS_PER_MILLI
+            }
+        }
+        if (includeCurrent) {
+            xs[history] = event.getX(pointerIndex)
+            ys[history] = event.getY(pointerIndex)
+            nanos[history] = if (precise) event.eventTimeNanos else event.eventTime * NANOS_PER_MILLI
+        }
+        return count
+    }
+
+    private companion object {
+        const val INITIAL_CAPACITY = 16
+        const val NANOS_PER_MILLI = 1_000_000L
+    }
+}
@@ -28,6 +28,8 @@ class PathCaptureView @JvmOverloads constructor(
         tracker = this@PathCaptureView.tracker
     }
 
+    private val batch = MotionBatch()
+
     init {
         isClickable = true
         initDebugContextFrom(context)
@@ -53,8 +55,9 @@ class PathCaptureView @JvmOverloads constructor(
             }
             MotionEvent.ACTION_MOVE -> {
                 val point = event.toPathPoint()
-                handleHistory(event)
-                tracker.onMove(point)
+                // History and the current sample in one batch: one update per MotionEvent.
+                val count = batch.fill(event, 0, includeCurrent = true)
+                tracker.onMoveBatch(batch.xs, batch.ys, batch.nanos, count)
                 overlayView.notifyTouchMove(point)
                 return true
             }
@@ -75,11 +78,8 @@ class PathCaptureView @JvmOverloads constructor(
     }
 
     private fun handleHistory(event: MotionEvent) {
-        val historySize = event.historySize
-        for (i in 0 until historySize) {
-            val point = PathPoint(event.getHistoricalX(i), event.getHistoricalY(i), event.getHistoricalEventTime(i))
-            tracker.onMove(point)
-        }
+        val count = batch.fill(event, 0, includeCurrent = false)
+        if (count > 0) tracker.onMoveBatch(batch.xs, batch.ys, batch.nanos, count)
     }
 }
 
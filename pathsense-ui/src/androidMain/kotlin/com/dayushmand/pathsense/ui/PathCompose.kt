@@ -1,24 +1,35 @@
 package com.dayushmand.pathsense.ui
 
+import android.graphics.LinearGradient
+import android.graphics.Matrix
 import android.os.SystemClock
-import androidx.compose.foundation.Canvas
+import androidx.compose.animation.core.Animatable
+import androidx.compose.animation.core.AnimationVector1D
+import androidx.compose.animation.core.LinearEasing
+import androidx.compose.animation.core.tween
 import androidx.compose.foundation.background
 import androidx.compose.foundation.gestures.awaitEachGesture
 import androidx.compose.foundation.gestures.awaitFirstDown
 import androidx.compose.foundation.layout.Box
+import androidx.compose.foundation.layout.Spacer
 import androidx.compose.foundation.layout.padding
 import androidx.compose.foundation.shape.RoundedCornerShape
 import androidx.compose.runtime.Composable
+import androidx.compose.runtime.DisposableEffect
 import androidx.compose.runtime.LaunchedEffect
 import androidx.compose.runtime.MutableState
+import androidx.compose.runtime.mutableLongStateOf
 import androidx.compose.runtime.mutableStateOf
 import androidx.compose.runtime.remember
 import androidx.compose.foundation.text.BasicText
 import androidx.compose.ui.Alignment
 import androidx.compose.ui.Modifier
+import androidx.compose.ui.draw.drawWithCache
 import androidx.compose.ui.geometry.Offset
+import androidx.compose.ui.geometry.Size
 import androidx.compose.ui.graphics.Brush
 import androidx.compose.ui.graphics.Path
+import androidx.compose.ui.graphics.ShaderBrush
 import androidx.compose.ui.graphics.drawscope.Stroke
 import androidx.compose.ui.graphics.graphicsLayer
 import androidx.compose.ui.input.pointer.changedToUp
@@ -29,10 +40,14 @@ import androidx.compose.ui.unit.dp
 import androidx.compose.ui.unit.sp
 import com.dayushmand.pathsense.core.PathPoint
 import com.dayushmand.pathsense.core.PathTracker
-import kotlinx.coroutines.delay
+import com.dayushmand.pathsense.core.PointView
+import kotlin.math.hypot
 import kotlin.math.max
+import kotlin.math.min
 
 private const val HUD_DEFAULT = "x: \u2013  y: \u2013  dx: \u2013  dy: \u2013"
+private const val PREDICTED_TAIL_ALPHA = 0.4f
+private val CIRCLE_STROKE = Stroke(width = 3f)
 
 @Composable
 fun PathCapture(
@@ -94,8 +109,17 @@ fun PathOverlay(
     fadeStartMillis: MutableState<Long?>? = null,
     hudText: MutableState<String>? = null,
 ) {
-    val now = remember { mutableStateOf(SystemClock.uptimeMillis()) }
     val fadeOutMs = overlayConfig.style.fadeOutMs
+    val fade = remember { Animatable(1f) }
+    val cache = remember { ComposeStrokeCache() }
+    // Bumped when the tracker's points change and read only while drawing, so
+    // a stroke in progress redraws the canvas without recomposing anything.
+    val drawTick = remember { mutableLongStateOf(0L) }
+    DisposableEffect(tracker) {
+        val invalidate: () -> Unit = { drawTick.longValue++ }
+        tracker.addPointsListener(invalidate)
+        onDispose { tracker.removePointsListener(invalidate) }
+    }
 
     // When no external hudText is provided, auto-derive from the tracker's events
     val effectiveHudText = hudText ?: if (overlayConfig.showCoordinateHUD) {
@@ -116,6 +140,12 @@ fun PathOverlay(
                             autoHud.value = formatHud(last, startPoint.value ?: last)
                         }
                     }
+                    is com.dayushmand.pathsense.core.PathEvent.Appended -> {
+                        val last = event.points.lastOrNull()
+                        if (last != null) {
+                            autoHud.value = formatHud(last, startPoint.value ?: last)
+                        }
+                    }
                     is com.dayushmand.pathsense.core.PathEvent.Ended -> {
                         val last = event.points.lastOrNull()
                         if (last != null) {
@@ -135,96 +165,104 @@ fun PathOverlay(
 
     LaunchedEffect(fadeStartMillis?.value, fadeOutMs) {
         val start = fadeStartMillis?.value
-        if (start != null && fadeOutMs > 0) {
-            while (true) {
-                now.value = SystemClock.uptimeMillis()
-                if (now.value - start > fadeOutMs) break
-                delay(16)
-            }
-            // Fade finished — clear points so the path won't redraw,
-            // then reset HUD text to placeholder.
-            tracker.clearPoints()
-            effectiveHudText?.value = HUD_DEFAULT
+        if (start == null || fadeOutMs <= 0) {
+            fade.snapTo(1f)
+            return@LaunchedEffect
         }
+        val remaining = (fadeOutMs - (SystemClock.uptimeMillis() - start)).coerceIn(0L, fadeOutMs)
+        fade.snapTo(remaining.toFloat() / fadeOutMs)
+        fade.animateTo(0f, tween(remaining.toInt(), easing = LinearEasing))
+        // Fade finished — clear points so the path won't redraw,
+        // then reset HUD text to placeholder.
+        tracker.clearPoints()
+        effectiveHudText?.value = HUD_DEFAULT
     }
 
     Box(modifier = modifier) {
-        Canvas(modifier = Modifier.matchParentSize()) {
-            if (!isDebugBuild() && overlayConfig.debugOnly) return@Canvas
-            val points = tracker.currentPoints
-            if (points.isEmpty()) return@Canvas
+        Spacer(
+            modifier = Modifier.matchParentSize().drawWithCache {
+                val style = overlayConfig.style
+                val stroke = Stroke(width = style.strokeWidthPx, cap = style.strokeCap.toComposeCap())
+                val boxStroke = Stroke(width = max(2f, style.strokeWidthPx / 2f))
+                val boxColor = style.boundingBoxColor.toComposeColor()
+                val startColor = style.gradientStartColor.toComposeColor()
+                val endColor = style.gradientEndColor.toComposeColor()
+                onDrawBehind {
+                    drawTick.longValue // subscribe this draw to point changes
+                    if (!isDebugBuild() && overlayConfig.debugOnly) return@onDrawBehind
+                    val points = tracker.points
+                    if (points.size == 0) return@onDrawBehind
 
-            val alpha = computeFadeAlpha(fadeStartMillis?.value, now.value, fadeOutMs)
-            if (alpha <= 0f) return@Canvas
+                    val alpha = fade.value
+                    if (alpha <= 0f) return@onDrawBehind
 
-            val path = buildComposePath(points)
-            val style = overlayConfig.style
-            val brush = Brush.linearGradient(
-                colors = listOf(style.gradientStartColor.toComposeColor(), style.gradientEndColor.toComposeColor()),
-                start = Offset(points.first().x, points.first().y),
-                end = Offset(points.last().x, points.last().y),
-            )
-            drawPath(
-                path = path,
-                brush = brush,
-                style = Stroke(width = style.strokeWidthPx, cap = style.strokeCap.toComposeCap()),
-                alpha = alpha,
-            )
+                    val last = points.size - 1
+                    val end = Offset(points.x(last), points.y(last))
+                    val brush = cache.brushFor(style, points.x(0), points.y(0), end.x, end.y)
+                    cache.sync(tracker, points)
+                    drawPath(path = cache.path, brush = brush, style = stroke, alpha = alpha)
+                    // The cached path ends at the midpoint of the last segment;
+                    // close the gap here so the cache stays append-only.
+                    val tailStart = if (last > 0) {
+                        Offset((points.x(last - 1) + end.x) / 2f, (points.y(last - 1) + end.y) / 2f)
+                    } else {
+                        end
+                    }
+                    drawLine(brush, tailStart, end, style.strokeWidthPx, stroke.cap, alpha = alpha)
+                    // Provisional tail to where the finger is predicted to be; dropped on lift.
+                    val predicted = tracker.predictedPoint
+                    if (predicted != null && fadeStartMillis?.value == null) {
+                        drawLine(
+                            brush = brush,
+                            start = end,
+                            end = Offset(predicted.x, predicted.y),
+                            strokeWidth = style.strokeWidthPx,
+                            cap = stroke.cap,
+                            alpha = alpha * PREDICTED_TAIL_ALPHA,
+                        )
+                    }
 
-            if (style.showBoundingBox) {
-                var minX = Float.POSITIVE_INFINITY
-                var minY = Float.POSITIVE_INFINITY
-                var maxX = Float.NEGATIVE_INFINITY
-                var maxY = Float.NEGATIVE_INFINITY
-                for (p in points) {
-                    minX = minX.coerceAtMost(p.x)
-                    minY = minY.coerceAtMost(p.y)
-                    maxX = maxX.coerceAtLeast(p.x)
-                    maxY = maxY.coerceAtLeast(p.y)
-                }
-                if (minX != Float.POSITIVE_INFINITY) {
-                    drawRect(
-                        color = style.boundingBoxColor.toComposeColor(),
-                        topLeft = Offset(minX, minY),
-                        size = androidx.compose.ui.geometry.Size(maxX - minX, maxY - minY),
-                        style = Stroke(width = max(2f, style.strokeWidthPx / 2f)),
-                        alpha = alpha,
-                    )
-                }
-            }
+                    if (style.showBoundingBox) {
+                        drawRect(
+                            color = boxColor,
+                            topLeft = Offset(cache.minX, cache.minY),
+                            size = Size(cache.maxX - cache.minX, cache.maxY - cache.minY),
+                            style = boxStroke,
+                            alpha = alpha,
+                        )
+                    }
 
-            if (overlayConfig.showCrosshair) {
-                val p = points.last()
-                drawLine(
-                    color = style.gradientEndColor.toComposeColor(),
-                    start = Offset(0f, p.y),
-                    end = Offset(size.width, p.y),
-                    strokeWidth = 2f,
-                    alpha = alpha * 0.7f,
-                )
-                drawLine(
-                    color = style.gradientEndColor.toComposeColor(),
-                    start = Offset(p.x, 0f),
-                    end = Offset(p.x, size.height),
-                    strokeWidth = 2f,
-                    alpha = alpha * 0.7f,
-                )
-            }
+                    if (overlayConfig.showCrosshair) {
+                        drawLine(
+                            color = endColor,
+                            start = Offset(0f, end.y),
+                            end = Offset(size.width, end.y),
+                            strokeWidth = 2f,
+                            alpha = alpha * 0.7f,
+                        )
+                        drawLine(
+                            color = endColor,
+                            start = Offset(end.x, 0f),
+                            end = Offset(end.x, size.height),
+                            strokeWidth = 2f,
+                            alpha = alpha * 0.7f,
+                        )
+                    }
 
-            if (overlayConfig.showTouchCircle) {
-                val p = points.last()
-                val radius = max(16f, style.strokeWidthPx * 3f)
-                drawCircle(
-                    color = style.gradientStartColor.toComposeColor(),
-                    radius = radius,
-                    center = Offset(p.x, p.y),
-                    alpha = alpha * 0.8f,
-                    style = Stroke(width = 3f),
-                )
-            }
-        }
+                    if (overlayConfig.showTouchCircle) {
+                        val radius = max(16f, style.strokeWidthPx * 3f)
+                        drawCircle(
+                            color = startColor,
+                            radius = radius,
+                            center = end,
+                            alpha = alpha * 0.8f,
+                            style = CIRCLE_STROKE,
+                        )
+                    }
+                }
+            },
+        )
 
-        // Coordinate HUD label — real Text composable (matches GesturePathKit's coordinateLabel)
         if (overlayConfig.showCoordinateHUD) {
             val alignment = when (overlayConfig.hudAlignment) {
                 HUDAlignment.TOP_LEFT -> Alignment.TopStart
@@ -234,55 +272,140 @@ fun PathOverlay(
                 HUDAlignment.CENTER_LEFT -> Alignment.CenterStart
                 HUDAlignment.CENTER_RIGHT -> Alignment.CenterEnd
             }
-            val hudAlpha = computeFadeAlpha(fadeStartMillis?.value, now.value, fadeOutMs)
-            BasicText(
-                text = effectiveHudText?.value ?: HUD_DEFAULT,
-                modifier = Modifier
-                    .align(alignment)
-                    .padding(12.dp)
-                    .graphicsLayer { alpha = hudAlpha }
-                    .background(
-                        overlayConfig.hudBackgroundColor.toComposeColor(),
-                        RoundedCornerShape(8.dp),
-                    )
-                    .padding(horizontal = 12.dp, vertical = 6.dp),
-                style = TextStyle(
-                    color = overlayConfig.hudTextColor.toComposeColor(),
-                    fontSize = 13.sp,
-                    fontFamily = FontFamily.Monospace,
-                ),
+            CoordinateHud(
+                modifier = Modifier.align(alignment),
+                text = effectiveHudText,
+                overlayConfig = overlayConfig,
+                fade = fade,
             )
         }
     }
 }
 
-private fun buildComposePath(points: List<PathPoint>): Path {
+/**
+ * Coordinate HUD label — real Text composable (matches GesturePathKit's
+ * coordinateLabel). Its own scope reads [text], so a HUD update per move
+ * recomposes only this label, not the overlay around it.
+ */
+@Composable
+private fun CoordinateHud(
+    modifier: Modifier,
+    text: MutableState<String>?,
+    overlayConfig: PathOverlayConfig,
+    fade: Animatable<Float, AnimationVector1D>,
+) {
+    BasicText(
+        text = text?.value ?: HUD_DEFAULT,
+        modifier = modifier
+            .padding(12.dp)
+            .graphicsLayer { alpha = fade.value }
+            .background(
+                overlayConfig.hudBackgroundColor.toComposeColor(),
+                RoundedCornerShape(8.dp),
+            )
+            .padding(horizontal = 12.dp, vertical = 6.dp),
+        style = TextStyle(
+            color = overlayConfig.hudTextColor.toComposeColor(),
+            fontSize = 13.sp,
+            fontFamily = FontFamily.Monospace,
+        ),
+    )
+}
+
+/**
+ * Compose twin of [PathOverlayView]'s render cache: the stroke path is only
+ * extended with new points, and rebuilt when points leave the head of the
+ * buffer or the tracker changes. The gradient shader is mapped onto the stroke
+ * with a matrix instead of being reallocated every frame.
+ */
+private class ComposeStrokeCache {
     val path = Path()
-    if (points.isEmpty()) return path
-    path.moveTo(points.first().x, points.first().y)
-    for (i in 1 until points.size) {
-        val prev = points[i - 1]
-        val curr = points[i]
-        val midX = (prev.x + curr.x) / 2f
-        val midY = (prev.y + curr.y) / 2f
-        path.quadraticBezierTo(prev.x, prev.y, midX, midY)
+    var minX = 0f
+    var minY = 0f
+    var maxX = 0f
+    var maxY = 0f
+
+    private var tracker: PathTracker? = null
+    private var version = 0L
+    private var evicted = 0L
+    private var brush: ShaderBrush? = null
+    private var shader: LinearGradient? = null
+    private var startColor = 0L
+    private var endColor = 0L
+    private val matrix = Matrix()
+
+    fun sync(tracker: PathTracker, points: PointView) {
+        val version = tracker.pointsVersion
+        val evicted = tracker.evictedCount
+        val from = this.version - evicted
+        if (tracker !== this.tracker || evicted != this.evicted || from < 1 || from > points.size) {
+            path.reset()
+            path.moveTo(points.x(0), points.y(0))
+            minX = points.x(0)
+            maxX = minX
+            minY = points.y(0)
+            maxY = minY
+            appendSegments(points, 1)
+        } else if (version != this.version) {
+            appendSegments(points, from.toInt())
+        }
+        this.tracker = tracker
+        this.version = version
+        this.evicted = evicted
+    }
+
+    private fun appendSegments(points: PointView, from: Int) {
+        for (i in from until points.size) {
+            val prevX = points.x(i - 1)
+            val prevY = points.y(i - 1)
+            val x = points.x(i)
+            val y = points.y(i)
+            path.quadraticBezierTo(prevX, prevY, (prevX + x) / 2f, (prevY + y) / 2f)
+            minX = min(minX, x)
+            minY = min(minY, y)
+            maxX = max(maxX, x)
+            maxY = max(maxY, y)
+        }
+    }
+
+    fun brushFor(style: PathStyle, startX: Float, startY: Float, endX: Float, endY: Float): Brush {
+        var shader = shader
+        var brush = brush
+        if (shader == null || brush == null ||
+            style.gradientStartColor != startColor || style.gradientEndColor != endColor
+        ) {
+            shader = LinearGradient(
+                0f, 0f, 1f, 0f,
+                style.gradientStartColor.toInt(), style.gradientEndColor.toInt(),
+                android.graphics.Shader.TileMode.CLAMP,
+            )
+            brush = ShaderBrush(shader)
+            this.shader = shader
+            this.brush = brush
+            startColor = style.gradientStartColor
+            endColor = style.gradientEndColor
+        }
+        // Map the unit gradient onto start → end.
+        val dx = endX - startX
+        val dy = endY - startY
+        val length = hypot(dx, dy)
+        if (length > 0f) {
+            matrix.setSinCos(dy / length, dx / length)
+        } else {
+            matrix.reset()
+        }
+        val scale = max(length, 1f)
+        matrix.preScale(scale, scale)
+        matrix.postTranslate(startX, startY)
+        shader.setLocalMatrix(matrix)
+        return brush
     }
-    val last = points.last()
-    path.lineTo(last.x, last.y)
-    return path
 }
 
 private fun Offset.toPoint(): PathPoint {
     return PathPoint(x, y, SystemClock.uptimeMillis())
 }
 
-private fun computeFadeAlpha(start: Long?, now: Long, fadeOutMs: Long): Float {
-    if (start == null || fadeOutMs <= 0) return 1f
-    val elapsed = (now - start).coerceAtLeast(0)
-    val t = elapsed.toFloat() / fadeOutMs.toFloat()
-    return (1f - t).coerceIn(0f, 1f)
-}
-
 private fun formatHud(current: PathPoint, start: PathPoint): String {
     val dx = current.x - start.x
     val dy = current.y - start.y
@@ -3,6 +3,7 @@ package com.dayushmand.pathsense.ui
 import android.content.Context
 import android.graphics.Canvas
 import android.graphics.LinearGradient
+import android.graphics.Matrix
 import android.graphics.Paint
 import android.graphics.Path
 import android.graphics.RectF as AndroidRectF
@@ -22,6 +23,8 @@ import android.widget.FrameLayout
 import android.widget.TextView
 import com.dayushmand.pathsense.core.PathPoint
 import com.dayushmand.pathsense.core.PathTracker
+import com.dayushmand.pathsense.core.PointView
+import kotlin.math.hypot
 import kotlin.math.max
 
 class PathOverlayView @JvmOverloads constructor(
@@ -42,6 +45,27 @@ class PathOverlayView @JvmOverloads constructor(
         style = Paint.Style.STROKE
     }
 
+    // ---- Render cache: reused every frame so drawing allocates nothing ----
+    private var pathTracker: PathTracker? = null
+    private var pathVersion = 0L
+    private var pathEvicted = 0L
+    private val pathBounds = AndroidRectF()
+    private var gradient: LinearGradient? = null
+    private var gradientStartColor = 0
+    private var gradientEndColor = 0
+    private val gradientMatrix = Matrix()
+    private val boxPaint = Paint(Paint.ANTI_ALIAS_FLAG).apply {
+        style = Paint.Style.STROKE
+    }
+    private val crossPaint = Paint(Paint.ANTI_ALIAS_FLAG).apply {
+        style = Paint.Style.STROKE
+        strokeWidth = 2f
+    }
+    private val circlePaint = Paint(Paint.ANTI_ALIAS_FLAG).apply {
+        style = Paint.Style.STROKE
+        strokeWidth = 3f
+    }
+
     private var fadeStartTime: Long? = null
     private var startPoint: PathPoint? = null
     private val handler = Handler(Looper.getMainLooper())
@@ -206,8 +230,9 @@ class PathOverlayView @JvmOverloads constructor(
         super.onDraw(canvas)
         if (!isDebugBuild() && overlayConfig.debugOnly) return
 
-        val points = tracker?.currentPoints.orEmpty()
-        if (points.isEmpty()) {
+        val tracker = tracker
+        val points = tracker?.points
+        if (tracker == null || points == null || points.size == 0) {
             // No points — ensure HUD label is fully opaque (reset state)
             hudLabel.alpha = 1f
             return
@@ -227,38 +252,42 @@ class PathOverlayView @JvmOverloads constructor(
         paint.strokeCap = style.strokeCap.toPaintCap()
         paint.alpha = (fadeAlpha * 255).toInt().coerceIn(0, 255)
 
-        val start = points.first()
-        val end = points.last()
-        paint.shader = LinearGradient(
-            start.x,
-            start.y,
-            end.x,
-            end.y,
-            style.gradientStartColor.toColorInt(),
-            style.gradientEndColor.toColorInt(),
-            Shader.TileMode.CLAMP,
-        )
-
-        buildPath(points, path)
+        val last = points.size - 1
+        val endX = points.x(last)
+        val endY = points.y(last)
+        paint.shader = gradientFor(style, points.x(0), points.y(0), endX, endY)
+
+        syncPath(tracker, points)
         canvas.drawPath(path, paint)
+        // The cached path ends at the midpoint of the last segment; close the
+        // gap to the newest point here so the cache stays append-only.
+        if (last > 0) {
+            val midX = (points.x(last - 1) + endX) / 2f
+            val midY = (points.y(last - 1) + endY) / 2f
+            canvas.drawLine(midX, midY, endX, endY, paint)
+        } else {
+            canvas.drawLine(endX, endY, endX, endY, paint)
+        }
+        // Provisional tail to where the finger is predicted to be; dropped on lift.
+        val predicted = tracker.predictedPoint
+        if (predicted != null && fadeStartTime == null) {
+            paint.alpha = (fadeAlpha * PREDICTED_TAIL_ALPHA).toInt().coerceIn(0, 255)
+            canvas.drawLine(endX, endY, predicted.x, predicted.y, paint)
+        }
 
         if (style.showBoundingBox) {
-            val bbox = computeBoundingBox(points)
-            val boxPaint = Paint(Paint.ANTI_ALIAS_FLAG).apply {
-                this.style = Paint.Style.STROKE
-                strokeWidth = max(2f, style.strokeWidthPx / 2f)
-                color = style.boundingBoxColor.toColorInt()
-                this.alpha = (fadeAlpha * 255).toInt().coerceIn(0, 255)
-            }
-            canvas.drawRect(bbox, boxPaint)
+            boxPaint.strokeWidth = max(2f, style.strokeWidthPx / 2f)
+            boxPaint.color = style.boundingBoxColor.toColorInt()
+            boxPaint.alpha = (fadeAlpha * 255).toInt().coerceIn(0, 255)
+            canvas.drawRect(pathBounds, boxPaint)
         }
 
         if (overlayConfig.showCrosshair) {
-            drawCrosshair(canvas, end, fadeAlpha)
+            drawCrosshair(canvas, endX, endY, fadeAlpha)
         }
 
         if (overlayConfig.showTouchCircle) {
-            drawTouchCircle(canvas, end, fadeAlpha)
+            drawTouchCircle(canvas, endX, endY, fadeAlpha)
         }
 
         // Keep invalidating during fade-out animation
@@ -276,61 +305,80 @@ class PathOverlayView @JvmOverloads constructor(
         return (1f - t).coerceIn(0f, 1f)
     }
 
-    private fun buildPath(points: List<PathPoint>, outPath: Path) {
-        outPath.reset()
-        if (points.isEmpty()) return
-        outPath.moveTo(points[0].x, points[0].y)
-        for (i in 1 until points.size) {
-            val prev = points[i - 1]
-            val curr = points[i]
-            val midX = (prev.x + curr.x) / 2f
-            val midY = (prev.y + curr.y) / 2f
-            outPath.quadTo(prev.x, prev.y, midX, midY)
+    /**
+     * Brings the cached [path] up to date with the tracker's buffer. New points
+     * are appended as quad segments; the path is only rebuilt when points left
+     * the head of the buffer (eviction, clear) or the tracker changed.
+     */
+    private fun syncPath(tracker: PathTracker, points: PointView) {
+        val version = tracker.pointsVersion
+        val evicted = tracker.evictedCount
+        val from = pathVersion - evicted
+        if (tracker !== pathTracker || evicted != pathEvicted || from < 1 || from > points.size) {
+            path.reset()
+            path.moveTo(points.x(0), points.y(0))
+            pathBounds.set(points.x(0), points.y(0), points.x(0), points.y(0))
+            appendSegments(points, 1)
+        } else if (version != pathVersion) {
+            appendSegments(points, from.toInt())
         }
-        val last = points.last()
-        outPath.lineTo(last.x, last.y)
+        pathTracker = tracker
+        pathVersion = version
+        pathEvicted = evicted
     }
 
-    private fun drawCrosshair(canvas: Canvas, point: PathPoint, alpha: Float) {
-        val crossPaint = Paint(Paint.ANTI_ALIAS_FLAG).apply {
-            style = Paint.Style.STROKE
-            strokeWidth = 2f
-            color = overlayConfig.style.gradientEndColor.toColorInt()
-            this.alpha = (alpha * 160).toInt().coerceIn(0, 255)
+    private fun appendSegments(points: PointView, from: Int) {
+        for (i in from until points.size) {
+            val prevX = points.x(i - 1)
+            val prevY = points.y(i - 1)
+            val x = points.x(i)
+            val y = points.y(i)
+            path.quadTo(prevX, prevY, (prevX + x) / 2f, (prevY + y) / 2f)
+            pathBounds.union(x, y)
         }
-        canvas.drawLine(0f, point.y, width.toFloat(), point.y, crossPaint)
-        canvas.drawLine(point.x, 0f, point.x, height.toFloat(), crossPaint)
     }
 
-    private fun drawTouchCircle(canvas: Canvas, point: PathPoint, alpha: Float) {
-        val circlePaint = Paint(Paint.ANTI_ALIAS_FLAG).apply {
-            style = Paint.Style.STROKE
-            strokeWidth = 3f
-            color = overlayConfig.style.gradientStartColor.toColorInt()
-            this.alpha = (alpha * 200).toInt().coerceIn(0, 255)
+    private fun gradientFor(style: PathStyle, startX: Float, startY: Float, endX: Float, endY: Float): Shader {
+        val startColor = style.gradientStartColor.toColorInt()
+        val endColor = style.gradientEndColor.toColorInt()
+        val shader = gradient?.takeIf { startColor == gradientStartColor && endColor == gradientEndColor }
+            ?: LinearGradient(0f, 0f, 1f, 0f, startColor, endColor, Shader.TileMode.CLAMP).also {
+                gradient = it
+                gradientStartColor = startColor
+                gradientEndColor = endColor
+            }
+        // Map the unit gradient onto start → end instead of allocating a new shader per frame.
+        val dx = endX - startX
+        val dy = endY - startY
+        val length = hypot(dx, dy)
+        if (length > 0f) {
+            gradientMatrix.setSinCos(dy / length, dx / length)
+        } else {
+            gradientMatrix.reset()
         }
-        val radius = max(16f, overlayConfig.style.strokeWidthPx * 3f)
-        canvas.drawCircle(point.x, point.y, radius, circlePaint)
+        val scale = max(length, 1f)
+        gradientMatrix.preScale(scale, scale)
+        gradientMatrix.postTranslate(startX, startY)
+        shader.setLocalMatrix(gradientMatrix)
+        return shader
     }
 
-    private fun computeBoundingBox(points: List<PathPoint>): AndroidRectF {
-        var minX = Float.POSITIVE_INFINITY
-        var minY = Float.POSITIVE_INFINITY
-        var maxX = Float.NEGATIVE_INFINITY
-        var maxY = Float.NEGATIVE_INFINITY
-        for (p in points) {
-            minX = minX.coerceAtMost(p.x)
-            minY = minY.coerceAtMost(p.y)
-            maxX = maxX.coerceAtLeast(p.x)
-            maxY = maxY.coerceAtLeast(p.y)
-        }
-        if (minX == Float.POSITIVE_INFINITY) {
-            minX = 0f; minY = 0f; maxX = 0f; maxY = 0f
-        }
-        return AndroidRectF(minX, minY, maxX, maxY)
+    private fun drawCrosshair(canvas: Canvas, x: Float, y: Float, alpha: Float) {
+        crossPaint.color = overlayConfig.style.gradientEndColor.toColorInt()
+        crossPaint.alpha = (alpha * 160).toInt().coerceIn(0, 255)
+        canvas.drawLine(0f, y, width.toFloat(), y, crossPaint)
+        canvas.drawLine(x, 0f, x, height.toFloat(), crossPaint)
+    }
+
+    private fun drawTouchCircle(canvas: Canvas, x: Float, y: Float, alpha: Float) {
+        circlePaint.color = overlayConfig.style.gradientStartColor.toColorInt()
+        circlePaint.alpha = (alpha * 200).toInt().coerceIn(0, 255)
+        val radius = max(16f, overlayConfig.style.strokeWidthPx * 3f)
+        canvas.drawCircle(x, y, radius, circlePaint)
     }
 
     companion object {
+        private const val PREDICTED_TAIL_ALPHA = 96
         internal const val HUD_DEFAULT = "x: \u2013  y: \u2013  dx: \u2013  dy: \u2013"
     }
 }
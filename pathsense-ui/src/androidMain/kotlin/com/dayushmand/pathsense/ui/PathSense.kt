@@ -5,6 +5,7 @@ import android.app.Application
 import android.os.Bundle
 import android.view.ViewGroup
 import android.widget.FrameLayout
+import com.dayushmand.pathsense.core.MultiPathTracker
 import com.dayushmand.pathsense.core.PathTracker
 import java.util.WeakHashMap
 
@@ -59,6 +60,13 @@ object PathSense {
     fun trackerFor(activity: Activity): PathTracker? =
         attachments[activity]?.tracker
 
+    /**
+     * Returns the [MultiPathTracker] attached to the given [activity], or
+     * `null` if [PathSenseConfig.multiPointerListener] is not set.
+     */
+    fun multiTrackerFor(activity: Activity): MultiPathTracker? =
+        attachments[activity]?.multiTracker
+
     // ---- internals ---------------------------------------------------------
 
     private fun attach(activity: Activity) {
@@ -66,6 +74,14 @@ object PathSense {
 
         val tracker = PathTracker(config.pathConfig)
         config.listener?.let { l -> tracker.listener = l }
+        config.heatmap?.let { heatmap ->
+            // A stroke hook, not the listener, so apps can still replace tracker.listener.
+            val screen = activity.javaClass.name
+            tracker.addStrokeListener { points -> heatmap.record(screen, points) }
+        }
+        val multiTracker = config.multiPointerListener?.let { l ->
+            MultiPathTracker(config.pathConfig).apply { listener = l }
+        }
 
         val overlay = PathOverlayView(activity).apply {
             this.tracker = tracker
@@ -86,20 +102,25 @@ object PathSense {
             wrapped = originalCallback,
             tracker = tracker,
             overlayView = overlay,
+            multiTracker = multiTracker,
         )
 
-        attachments[activity] = Attachment(tracker, overlay)
+        attachments[activity] = Attachment(tracker, overlay, multiTracker)
     }
 
     private fun detach(activity: Activity) {
         val attachment = attachments.remove(activity) ?: return
         val decor = activity.window.decorView as? FrameLayout
         decor?.removeView(attachment.overlay)
+        attachment.overlay.tracker = null
+        attachment.tracker.close()
+        attachment.multiTracker?.close()
     }
 
     private class Attachment(
         val tracker: PathTracker,
         val overlay: PathOverlayView,
+        val multiTracker: MultiPathTracker?,
     )
 
     private class Callbacks : Application.ActivityLifecycleCallbacks {
@@ -1,7 +1,9 @@
 package com.dayushmand.pathsense.ui
 
 import com.dayushmand.pathsense.core.PathConfig
+import com.dayushmand.pathsense.core.MultiPathTracker
 import com.dayushmand.pathsense.core.PathEvent
+import com.dayushmand.pathsense.core.TouchHeatmap
 
 /**
  * Configuration for [PathSense] auto-initialization.
@@ -9,9 +11,15 @@ import com.dayushmand.pathsense.core.PathEvent
  * @param pathConfig Core path tracking configuration (sampling rate, smoothing, etc.)
  * @param overlayConfig Visual overlay configuration (style, crosshair, HUD, etc.)
  * @param listener Optional global callback for all [PathEvent]s across every Activity
+ * @param multiPointerListener When set, every pointer is also tracked by a [MultiPathTracker]
+ *   and its events are delivered here with their pointer id
+ * @param heatmap When set, every finished stroke in every Activity is added to it,
+ *   keyed by the Activity's class name; safe to leave on in release builds
  */
 data class PathSenseConfig(
     val pathConfig: PathConfig = PathConfig(),
     val overlayConfig: PathOverlayConfig = PathOverlayConfig(),
     val listener: ((PathEvent) -> Unit)? = null,
+    val multiPointerListener: ((pointerId: Int, event: PathEvent) -> Unit)? = null,
+    val heatmap: TouchHeatmap? = null,
 )
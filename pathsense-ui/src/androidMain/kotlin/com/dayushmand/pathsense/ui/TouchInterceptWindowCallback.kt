@@ -2,6 +2,7 @@ package com.dayushmand.pathsense.ui
 
 import android.view.MotionEvent
 import android.view.Window
+import com.dayushmand.pathsense.core.MultiPathTracker
 import com.dayushmand.pathsense.core.PathPoint
 import com.dayushmand.pathsense.core.PathTracker
 
@@ -9,21 +10,28 @@ import com.dayushmand.pathsense.core.PathTracker
  * Wraps the original [Window.Callback] to transparently observe touch events
  * and feed them to a [PathTracker]. All events are passed through to the
  * original callback — the app's touch handling is completely unaffected.
+ *
+ * [tracker] follows the first pointer; when [multiTracker] is set, every
+ * pointer is also fed to it.
  */
 internal class TouchInterceptWindowCallback(
     private val wrapped: Window.Callback,
     private val tracker: PathTracker,
     private val overlayView: PathOverlayView,
+    private val multiTracker: MultiPathTracker? = null,
 ) : Window.Callback by wrapped {
 
     private var trackingPointerId = -1
 
+    private val batch = MotionBatch()
+
     override fun dispatchTouchEvent(event: MotionEvent?): Boolean {
         event?.let { observeTouch(it) }
         return wrapped.dispatchTouchEvent(event)
     }
 
     private fun observeTouch(event: MotionEvent) {
+        multiTracker?.let { observeAllPointers(it, event) }
         when (event.actionMasked) {
             MotionEvent.ACTION_DOWN -> {
                 trackingPointerId = event.getPointerId(0)
@@ -37,8 +45,8 @@ internal class TouchInterceptWindowCallback(
                 val idx = event.findPointerIndex(trackingPointerId)
                 if (idx >= 0) {
                     val point = event.toPathPoint(idx)
-                    processHistory(event, idx)
-                    tracker.onMove(point)
+                    val count = batch.fill(event, idx, includeCurrent = true)
+                    tracker.onMoveBatch(batch.xs, batch.ys, batch.nanos, count)
                     overlayView.notifyTouchMove(point)
                 }
             }
@@ -72,16 +80,33 @@ internal class TouchInterceptWindowCallback(
         }
     }
 
-    private fun processHistory(event: MotionEvent, pointerIndex: Int) {
-        for (h in 0 until event.historySize) {
-            val point = PathPoint(
-                event.getHistoricalX(pointerIndex, h),
-                event.getHistoricalY(pointerIndex, h),
-                event.getHistoricalEventTime(h),
-            )
-            tracker.onMove(point)
+    private fun observeAllPointers(multi: MultiPathTracker, event: MotionEvent) {
+        when (event.actionMasked) {
+            MotionEvent.ACTION_DOWN, MotionEvent.ACTION_POINTER_DOWN -> {
+                val idx = event.actionIndex
+                multi.onDown(event.getPointerId(idx), event.toPathPoint(idx))
+            }
+
+            MotionEvent.ACTION_MOVE -> {
+                for (idx in 0 until event.pointerCount) {
+                    val count = batch.fill(event, idx, includeCurrent = true)
+                    multi.onMoveBatch(event.getPointerId(idx), batch.xs, batch.ys, batch.nanos, count)
+                }
+            }
+
+            MotionEvent.ACTION_UP, MotionEvent.ACTION_POINTER_UP -> {
+                val idx = event.actionIndex
+                multi.onUp(event.getPointerId(idx), event.toPathPoint(idx))
+            }
+
+            MotionEvent.ACTION_CANCEL -> multi.onCancelAll()
         }
     }
+
+    private fun processHistory(event: MotionEvent, pointerIndex: Int) {
+        val count = batch.fill(event, pointerIndex, includeCurrent = false)
+        if (count > 0) tracker.onMoveBatch(batch.xs, batch.ys, batch.nanos, count)
+    }
 }
 
 private fun MotionEvent.toPathPoint(pointerIndex: Int): PathPoint =